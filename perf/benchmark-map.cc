@@ -0,0 +1,96 @@
+/*
+ * Benchmarks for hb_map_t; hb_hashmap_t behind it is what the subsetter
+ * uses for its glyph and lookup maps.  To compare implementations, run
+ * this on both revisions with --benchmark_format=json and diff the
+ * results.
+ */
+#include "benchmark/benchmark.h"
+
+#include "hb.h"
+
+/* Keys as the subsetter sees them: glyph ids, which are small and often
+ * consecutive, and scattered 32-bit values. */
+enum keys_t { DENSE, RANDOM };
+
+static hb_codepoint_t
+key_for (keys_t keys, unsigned i)
+{
+  if (keys == DENSE)
+    return i;
+  /* xorshift; a bijection, so keys do not repeat. */
+  uint32_t x = i + 1;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x == HB_MAP_VALUE_INVALID ? 0 : x;
+}
+
+static hb_map_t *
+map_with (keys_t keys, unsigned n)
+{
+  hb_map_t *map = hb_map_create ();
+  for (unsigned i = 0; i < n; i++)
+    hb_map_set (map, key_for (keys, i), i);
+  assert (hb_map_get_population (map) == n);
+  return map;
+}
+
+/* Building a map of range (0) entries from empty. */
+static void map_insert (benchmark::State &state, keys_t keys)
+{
+  unsigned n = state.range (0);
+  for (auto _ : state)
+  {
+    hb_map_t *map = map_with (keys, n);
+    hb_map_destroy (map);
+  }
+  state.SetItemsProcessed (state.iterations () * n);
+}
+
+/* Looking up keys that are all present, or all missing. */
+static void map_lookup (benchmark::State &state, keys_t keys, bool hit)
+{
+  unsigned n = state.range (0);
+  hb_map_t *map = map_with (keys, n);
+  unsigned offset = hit ? 0 : n;
+  for (auto _ : state)
+  {
+    hb_codepoint_t sum = 0;
+    for (unsigned i = 0; i < n; i++)
+      sum += hb_map_get (map, key_for (keys, offset + i));
+    benchmark::DoNotOptimize (sum);
+  }
+  state.SetItemsProcessed (state.iterations () * n);
+  hb_map_destroy (map);
+}
+
+/* Deleting and re-adding every key, keeping the population constant. */
+static void map_churn (benchmark::State &state, keys_t keys)
+{
+  unsigned n = state.range (0);
+  hb_map_t *map = map_with (keys, n);
+  for (auto _ : state)
+  {
+    for (unsigned i = 0; i < n; i++)
+      hb_map_del (map, key_for (keys, i));
+    for (unsigned i = 0; i < n; i++)
+      hb_map_set (map, key_for (keys, i), i);
+  }
+  state.SetItemsProcessed (state.iterations () * n * 2);
+  hb_map_destroy (map);
+}
+
+#define MAP_BENCHMARK(func, ...) \
+  BENCHMARK_CAPTURE (func, __VA_ARGS__) \
+    ->RangeMultiplier (16)->Range (16, 1 << 20)
+
+MAP_BENCHMARK (map_insert, dense, DENSE);
+MAP_BENCHMARK (map_insert, random, RANDOM);
+MAP_BENCHMARK (map_lookup, dense hit, DENSE, true);
+MAP_BENCHMARK (map_lookup, random hit, RANDOM, true);
+MAP_BENCHMARK (map_lookup, dense miss, DENSE, false);
+MAP_BENCHMARK (map_lookup, random miss, RANDOM, false);
+MAP_BENCHMARK (map_churn, dense, DENSE);
+MAP_BENCHMARK (map_churn, random, RANDOM);
+
+BENCHMARK_MAIN ();
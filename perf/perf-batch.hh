@@ -0,0 +1,106 @@
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+#include "hb.h"
+
+/* Shaping a text word by word, the way layout engines do, with one
+ * hb_shape() call per word, one hb_shape_batch_utf8() call for all, or
+ * one hb_shape_cached() call per word.  Words are separated by spaces or
+ * newlines. */
+enum batch_mode_t { ONE_BY_ONE, BATCH, CACHED };
+
+static void shape_words (benchmark::State &state, batch_mode_t mode,
+			 const char *text_path,
+			 hb_direction_t direction, hb_script_t script,
+			 const char *font_path)
+{
+  hb_font_t *font;
+  {
+    hb_blob_t *blob = hb_blob_create_from_file_or_fail (font_path);
+    assert (blob);
+    hb_face_t *face = hb_face_create (blob, 0);
+    hb_blob_destroy (blob);
+    font = hb_font_create (face);
+    hb_face_destroy (face);
+  }
+
+  hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (text_path);
+  assert (text_blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (text_blob, &text_length);
+
+  std::vector<hb_shape_batch_run_t> runs;
+  for (unsigned start = 0, i = 0; i <= text_length; i++)
+  {
+    if (i < text_length && text[i] != ' ' && text[i] != '\n')
+      continue;
+    if (i > start)
+    {
+      hb_shape_batch_run_t run = {};
+      run.offset = start;
+      run.length = i - start;
+      run.props.direction = direction;
+      run.props.script = script;
+      runs.push_back (run);
+    }
+    start = i + 1;
+  }
+
+  hb_shape_cache_t *cache = hb_shape_cache_create ();
+  hb_buffer_t *buf = hb_buffer_create ();
+  for (auto _ : state)
+  {
+    if (mode == BATCH)
+    {
+      bool ret = hb_shape_batch_utf8 (font, buf, text, text_length,
+				      runs.data (), runs.size (), nullptr, 0);
+      assert (ret);
+      continue;
+    }
+
+    for (const hb_shape_batch_run_t &run : runs)
+    {
+      hb_buffer_clear_contents (buf);
+      hb_buffer_add_utf8 (buf, text, text_length, run.offset, run.length);
+      hb_buffer_set_direction (buf, direction);
+      hb_buffer_set_script (buf, script);
+      if (mode == CACHED)
+	hb_shape_cached (cache, font, buf, nullptr, 0);
+      else
+	hb_shape (font, buf, nullptr, 0);
+    }
+  }
+  state.SetItemsProcessed (state.iterations () * runs.size ());
+  hb_buffer_destroy (buf);
+  hb_shape_cache_destroy (cache);
+
+  hb_blob_destroy (text_blob);
+  hb_font_destroy (font);
+}
+
+BENCHMARK_CAPTURE (shape_words, en-words.txt - Roboto one-by-one, ONE_BY_ONE,
+		   "perf/texts/en-words.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_LATIN,
+		   "perf/fonts/Roboto-Regular.ttf");
+BENCHMARK_CAPTURE (shape_words, en-words.txt - Roboto batch, BATCH,
+		   "perf/texts/en-words.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_LATIN,
+		   "perf/fonts/Roboto-Regular.ttf");
+BENCHMARK_CAPTURE (shape_words, en-words.txt - Roboto cached, CACHED,
+		   "perf/texts/en-words.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_LATIN,
+		   "perf/fonts/Roboto-Regular.ttf");
+
+BENCHMARK_CAPTURE (shape_words, fa-thelittleprince.txt - Amiri one-by-one, ONE_BY_ONE,
+		   "perf/texts/fa-thelittleprince.txt",
+		   HB_DIRECTION_RTL, HB_SCRIPT_ARABIC,
+		   "perf/fonts/Amiri-Regular.ttf");
+BENCHMARK_CAPTURE (shape_words, fa-thelittleprince.txt - Amiri batch, BATCH,
+		   "perf/texts/fa-thelittleprince.txt",
+		   HB_DIRECTION_RTL, HB_SCRIPT_ARABIC,
+		   "perf/fonts/Amiri-Regular.ttf");
+BENCHMARK_CAPTURE (shape_words, fa-thelittleprince.txt - Amiri cached, CACHED,
+		   "perf/texts/fa-thelittleprince.txt",
+		   HB_DIRECTION_RTL, HB_SCRIPT_ARABIC,
+		   "perf/fonts/Amiri-Regular.ttf");
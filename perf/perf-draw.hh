@@ -142,6 +142,72 @@ static void draw (benchmark::State &state, const char *font_path, bool is_var, b
   hb_font_destroy (font);
 }
 
+/* Drawing the same glyphs over and over, the way a rasterizer does for
+ * the glyphs of a page, by decoding them each time with
+ * hb_font_draw_glyph(), by replaying paths fetched once with
+ * hb_font_get_glyph_path(), or by fetching the paths from the font's
+ * cache each time. */
+enum draw_mode_t { DECODE, REPLAY, FETCH_AND_REPLAY };
+
+static void draw_retained (benchmark::State &state, const char *font_path, bool is_var, draw_mode_t mode)
+{
+  hb_font_t *font;
+  unsigned num_glyphs;
+  {
+    hb_blob_t *blob = hb_blob_create_from_file_or_fail (font_path);
+    assert (blob);
+    hb_face_t *face = hb_face_create (blob, 0);
+    hb_blob_destroy (blob);
+    num_glyphs = hb_face_get_glyph_count (face);
+    font = hb_font_create (face);
+    hb_face_destroy (face);
+  }
+  /* Small enough to stay in the font's path cache. */
+  if (num_glyphs > 200) num_glyphs = 200;
+
+  if (is_var)
+  {
+    hb_variation_t wght = {HB_TAG ('w','g','h','t'), 500};
+    hb_font_set_variations (font, &wght, 1);
+  }
+  hb_draw_funcs_t *draw_funcs = hb_draw_funcs_create ();
+  hb_draw_funcs_set_move_to_func (draw_funcs, _hb_move_to);
+  hb_draw_funcs_set_line_to_func (draw_funcs, _hb_line_to);
+  hb_draw_funcs_set_quadratic_to_func (draw_funcs, _hb_quadratic_to);
+  hb_draw_funcs_set_cubic_to_func (draw_funcs, _hb_cubic_to);
+  hb_draw_funcs_set_close_path_func (draw_funcs, _hb_close_path);
+
+  hb_glyph_path_t **paths = (hb_glyph_path_t **) calloc (num_glyphs, sizeof (paths[0]));
+  for (unsigned gid = 0; gid < num_glyphs; ++gid)
+    paths[gid] = hb_font_get_glyph_path (font, gid);
+
+  for (auto _ : state)
+    for (unsigned gid = 0; gid < num_glyphs; ++gid)
+      switch (mode)
+      {
+      case DECODE:
+	hb_font_draw_glyph (font, gid, draw_funcs, nullptr);
+	break;
+      case REPLAY:
+	hb_glyph_path_draw (paths[gid], draw_funcs, nullptr);
+	break;
+      case FETCH_AND_REPLAY:
+      {
+	hb_glyph_path_t *path = hb_font_get_glyph_path (font, gid);
+	hb_glyph_path_draw (path, draw_funcs, nullptr);
+	hb_glyph_path_destroy (path);
+	break;
+      }
+      }
+  state.SetItemsProcessed (state.iterations () * num_glyphs);
+
+  for (unsigned gid = 0; gid < num_glyphs; ++gid)
+    hb_glyph_path_destroy (paths[gid]);
+  free (paths);
+  hb_draw_funcs_destroy (draw_funcs);
+  hb_font_destroy (font);
+}
+
 #define FONT_BASE_PATH "test/subset/data/fonts/"
 
 BENCHMARK_CAPTURE (draw, cff - ot - SourceSansPro, FONT_BASE_PATH "SourceSansPro-Regular.otf", false, HARFBUZZ);
@@ -175,3 +241,19 @@ BENCHMARK_CAPTURE (draw, glyf/vf - tp - Comfortaa, FONT_BASE_PATH "Comfortaa-Reg
 BENCHMARK_CAPTURE (draw, glyf - ot - Roboto, FONT_BASE_PATH "Roboto-Regular.ttf", false, HARFBUZZ);
 BENCHMARK_CAPTURE (draw, glyf - ft - Roboto, FONT_BASE_PATH "Roboto-Regular.ttf", false, FREETYPE);
 BENCHMARK_CAPTURE (draw, glyf - tp - Roboto, FONT_BASE_PATH "Roboto-Regular.ttf", false, TTF_PARSER);
+
+BENCHMARK_CAPTURE (draw_retained, cff - decode - SourceSansPro, FONT_BASE_PATH "SourceSansPro-Regular.otf", false, DECODE);
+BENCHMARK_CAPTURE (draw_retained, cff - replay - SourceSansPro, FONT_BASE_PATH "SourceSansPro-Regular.otf", false, REPLAY);
+BENCHMARK_CAPTURE (draw_retained, cff - fetch-and-replay - SourceSansPro, FONT_BASE_PATH "SourceSansPro-Regular.otf", false, FETCH_AND_REPLAY);
+
+BENCHMARK_CAPTURE (draw_retained, cff2/vf - decode - AdobeVFPrototype, FONT_BASE_PATH "AdobeVFPrototype.otf", true, DECODE);
+BENCHMARK_CAPTURE (draw_retained, cff2/vf - replay - AdobeVFPrototype, FONT_BASE_PATH "AdobeVFPrototype.otf", true, REPLAY);
+BENCHMARK_CAPTURE (draw_retained, cff2/vf - fetch-and-replay - AdobeVFPrototype, FONT_BASE_PATH "AdobeVFPrototype.otf", true, FETCH_AND_REPLAY);
+
+BENCHMARK_CAPTURE (draw_retained, glyf/vf - decode - SourceSerifVariable, FONT_BASE_PATH "SourceSerifVariable-Roman.ttf", true, DECODE);
+BENCHMARK_CAPTURE (draw_retained, glyf/vf - replay - SourceSerifVariable, FONT_BASE_PATH "SourceSerifVariable-Roman.ttf", true, REPLAY);
+BENCHMARK_CAPTURE (draw_retained, glyf/vf - fetch-and-replay - SourceSerifVariable, FONT_BASE_PATH "SourceSerifVariable-Roman.ttf", true, FETCH_AND_REPLAY);
+
+BENCHMARK_CAPTURE (draw_retained, glyf - decode - Roboto, FONT_BASE_PATH "Roboto-Regular.ttf", false, DECODE);
+BENCHMARK_CAPTURE (draw_retained, glyf - replay - Roboto, FONT_BASE_PATH "Roboto-Regular.ttf", false, REPLAY);
+BENCHMARK_CAPTURE (draw_retained, glyf - fetch-and-replay - Roboto, FONT_BASE_PATH "Roboto-Regular.ttf", false, FETCH_AND_REPLAY);
@@ -68,6 +68,10 @@ BENCHMARK_CAPTURE (extents, cff - ot - SourceSansPro, FONT_BASE_PATH "SourceSans
 BENCHMARK_CAPTURE (extents, cff - ft - SourceSansPro, FONT_BASE_PATH "SourceSansPro-Regular.otf", false, FREETYPE);
 BENCHMARK_CAPTURE (extents, cff - tp - SourceSansPro, FONT_BASE_PATH "SourceSansPro-Regular.otf", false, TTF_PARSER);
 
+BENCHMARK_CAPTURE (extents, cff - ot - SourceHanSans, FONT_BASE_PATH "SourceHanSans-Regular_subset.otf", false, HARFBUZZ);
+BENCHMARK_CAPTURE (extents, cff - ft - SourceHanSans, FONT_BASE_PATH "SourceHanSans-Regular_subset.otf", false, FREETYPE);
+BENCHMARK_CAPTURE (extents, cff - tp - SourceHanSans, FONT_BASE_PATH "SourceHanSans-Regular_subset.otf", false, TTF_PARSER);
+
 BENCHMARK_CAPTURE (extents, cff2 - ot - AdobeVFPrototype, FONT_BASE_PATH "AdobeVFPrototype.otf", false, HARFBUZZ);
 BENCHMARK_CAPTURE (extents, cff2 - ft - AdobeVFPrototype, FONT_BASE_PATH "AdobeVFPrototype.otf", false, FREETYPE);
 BENCHMARK_CAPTURE (extents, cff2 - tp - AdobeVFPrototype, FONT_BASE_PATH "AdobeVFPrototype.otf", false, TTF_PARSER);
@@ -2,9 +2,14 @@
 
 #include "hb.h"
 
+/* Fonts that are not in perf/fonts are borrowed from the test suites. */
+#define TEST_FONTS_PATH "test/subset/data/fonts/"
+#define SHAPING_FONTS_PATH "test/shaping/data/"
+
 static void shape (benchmark::State &state, const char *text_path,
 		   hb_direction_t direction, hb_script_t script,
-		   const char *font_path)
+		   const char *font_path, const char *variation = nullptr,
+		   hb_buffer_flags_t flags = HB_BUFFER_FLAG_DEFAULT)
 {
   hb_font_t *font;
   {
@@ -16,6 +21,14 @@ static void shape (benchmark::State &state, const char *text_path,
     hb_face_destroy (face);
   }
 
+  if (variation)
+  {
+    hb_variation_t var;
+    bool ret = hb_variation_from_string (variation, -1, &var);
+    assert (ret);
+    hb_font_set_variations (font, &var, 1);
+  }
+
   hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (text_path);
   assert (text_blob);
   unsigned text_length;
@@ -27,15 +40,22 @@ static void shape (benchmark::State &state, const char *text_path,
     hb_buffer_add_utf8 (buf, text, text_length, 0, -1);
     hb_buffer_set_direction (buf, direction);
     hb_buffer_set_script (buf, script);
+    hb_buffer_set_flags (buf, flags);
     hb_shape (font, buf, nullptr, 0);
     hb_buffer_clear_contents (buf);
   }
+  state.SetBytesProcessed (state.iterations () * text_length);
   hb_buffer_destroy (buf);
 
   hb_blob_destroy (text_blob);
   hb_font_destroy (font);
 }
 
+/* Benchmark names are used as keys when comparing JSON results
+ * (--benchmark_format=json) between releases; do not rename them. */
+
+/* Arabic shaper. */
+
 BENCHMARK_CAPTURE (shape, fa-thelittleprince.txt - Amiri,
 		   "perf/texts/fa-thelittleprince.txt",
 		   HB_DIRECTION_RTL, HB_SCRIPT_ARABIC,
@@ -54,6 +74,8 @@ BENCHMARK_CAPTURE (shape, fa-monologue.txt - NotoNastaliqUrdu,
 		   HB_DIRECTION_RTL, HB_SCRIPT_ARABIC,
 		   "perf/fonts/NotoNastaliqUrdu-Regular.ttf");
 
+/* Default shaper. */
+
 BENCHMARK_CAPTURE (shape, en-thelittleprince.txt - Roboto,
 		   "perf/texts/en-thelittleprince.txt",
 		   HB_DIRECTION_LTR, HB_SCRIPT_LATIN,
@@ -63,3 +85,127 @@ BENCHMARK_CAPTURE (shape, en-words.txt - Roboto,
 		   "perf/texts/en-words.txt",
 		   HB_DIRECTION_LTR, HB_SCRIPT_LATIN,
 		   "perf/fonts/Roboto-Regular.ttf");
+
+/* Hebrew shaper. */
+
+BENCHMARK_CAPTURE (shape, he-udhr.txt - Mplus1p,
+		   "perf/texts/he-udhr.txt",
+		   HB_DIRECTION_RTL, HB_SCRIPT_HEBREW,
+		   TEST_FONTS_PATH "Mplus1p-Regular.ttf");
+
+/* Indic shaper. */
+
+BENCHMARK_CAPTURE (shape, hi-udhr.txt - NotoSansDevanagari,
+		   "perf/texts/hi-udhr.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_DEVANAGARI,
+		   "perf/fonts/NotoSansDevanagari-Regular.ttf");
+
+/* Khmer shaper. */
+
+BENCHMARK_CAPTURE (shape, km-udhr.txt - Khmer GSUB,
+		   "perf/texts/km-udhr.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_KHMER,
+		   SHAPING_FONTS_PATH "in-house/fonts/3998336402905b8be8301ef7f47cf7e050cbb1bd.ttf");
+
+/* Myanmar shaper; the font is CFF-flavored. */
+
+BENCHMARK_CAPTURE (shape, my-udhr.txt - NotoSerifMyanmar,
+		   "perf/texts/my-udhr.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_MYANMAR,
+		   TEST_FONTS_PATH "NotoSerifMyanmar-Regular.otf");
+
+/* Myanmar Zawgyi shaper; only selected by script, so any font does. */
+
+BENCHMARK_CAPTURE (shape, my-udhr.txt - NotoSerifMyanmar Zawgyi,
+		   "perf/texts/my-udhr.txt",
+		   HB_DIRECTION_LTR, (hb_script_t) HB_TAG ('Q','a','a','g'),
+		   TEST_FONTS_PATH "NotoSerifMyanmar-Regular.otf");
+
+/* Thai shaper. */
+
+BENCHMARK_CAPTURE (shape, th-udhr.txt - Kanit,
+		   "perf/texts/th-udhr.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_THAI,
+		   "test/fuzzing/fonts/kanit.ttf");
+
+/* Universal Shaping Engine. */
+
+BENCHMARK_CAPTURE (shape, ban-clusters.txt - NotoSansBalinese,
+		   "perf/texts/ban-clusters.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_BALINESE,
+		   SHAPING_FONTS_PATH "text-rendering-tests/fonts/NotoSansBalinese-Regular.ttf");
+
+/* Hangul shaper.  There is no Hangul font in the tree; with none of the
+ * syllables in the font, this measures the decomposition fallback. */
+
+BENCHMARK_CAPTURE (shape, ko-udhr.txt - Mplus1p,
+		   "perf/texts/ko-udhr.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_HANGUL,
+		   TEST_FONTS_PATH "Mplus1p-Regular.ttf");
+
+/* Vertical text. */
+
+BENCHMARK_CAPTURE (shape, ja-udhr.txt - Mplus1p ttb,
+		   "perf/texts/ja-udhr.txt",
+		   HB_DIRECTION_TTB, HB_SCRIPT_HIRAGANA,
+		   TEST_FONTS_PATH "Mplus1p-Regular.ttf");
+
+/* AAT; horizontal Khmer goes through morx and the dumber shaper. */
+
+BENCHMARK_CAPTURE (shape, km-udhr.txt - Khmer morx,
+		   "perf/texts/km-udhr.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_KHMER,
+		   TEST_FONTS_PATH "Khmer.ttf");
+
+/* CFF and CFF2. */
+
+BENCHMARK_CAPTURE (shape, en-thelittleprince.txt - SourceSansPro,
+		   "perf/texts/en-thelittleprince.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_LATIN,
+		   TEST_FONTS_PATH "SourceSansPro-Regular.otf");
+BENCHMARK_CAPTURE (shape, en-thelittleprince.txt - AdobeVFPrototype,
+		   "perf/texts/en-thelittleprince.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_LATIN,
+		   TEST_FONTS_PATH "AdobeVFPrototype.otf");
+BENCHMARK_CAPTURE (shape, en-thelittleprince.txt - AdobeVFPrototype wght=900,
+		   "perf/texts/en-thelittleprince.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_LATIN,
+		   TEST_FONTS_PATH "AdobeVFPrototype.otf", "wght=900");
+
+/* Variable TrueType at several coordinates. */
+
+BENCHMARK_CAPTURE (shape, en-thelittleprince.txt - SourceSerifVariable,
+		   "perf/texts/en-thelittleprince.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_LATIN,
+		   TEST_FONTS_PATH "SourceSerifVariable-Roman.ttf");
+BENCHMARK_CAPTURE (shape, en-thelittleprince.txt - SourceSerifVariable wght=300,
+		   "perf/texts/en-thelittleprince.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_LATIN,
+		   TEST_FONTS_PATH "SourceSerifVariable-Roman.ttf", "wght=300");
+BENCHMARK_CAPTURE (shape, en-thelittleprince.txt - SourceSerifVariable wght=900,
+		   "perf/texts/en-thelittleprince.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_LATIN,
+		   TEST_FONTS_PATH "SourceSerifVariable-Roman.ttf", "wght=900");
+
+/* Without cluster tracking, for comparison with the same texts above. */
+
+BENCHMARK_CAPTURE (shape, fa-thelittleprince.txt - Amiri skip-cluster-tracking,
+		   "perf/texts/fa-thelittleprince.txt",
+		   HB_DIRECTION_RTL, HB_SCRIPT_ARABIC,
+		   "perf/fonts/Amiri-Regular.ttf", nullptr,
+		   HB_BUFFER_FLAG_SKIP_CLUSTER_TRACKING);
+BENCHMARK_CAPTURE (shape, en-thelittleprince.txt - Roboto skip-cluster-tracking,
+		   "perf/texts/en-thelittleprince.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_LATIN,
+		   "perf/fonts/Roboto-Regular.ttf", nullptr,
+		   HB_BUFFER_FLAG_SKIP_CLUSTER_TRACKING);
+BENCHMARK_CAPTURE (shape, hi-udhr.txt - NotoSansDevanagari skip-cluster-tracking,
+		   "perf/texts/hi-udhr.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_DEVANAGARI,
+		   "perf/fonts/NotoSansDevanagari-Regular.ttf", nullptr,
+		   HB_BUFFER_FLAG_SKIP_CLUSTER_TRACKING);
+BENCHMARK_CAPTURE (shape, ban-clusters.txt - NotoSansBalinese skip-cluster-tracking,
+		   "perf/texts/ban-clusters.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_BALINESE,
+		   SHAPING_FONTS_PATH "text-rendering-tests/fonts/NotoSansBalinese-Regular.ttf", nullptr,
+		   HB_BUFFER_FLAG_SKIP_CLUSTER_TRACKING);
@@ -0,0 +1,143 @@
+#include "benchmark/benchmark.h"
+
+#include "hb.h"
+#include "hb-subset.h"
+
+static hb_face_t *
+subset_source_face (const char *font_path)
+{
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (font_path);
+  assert (blob);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  return face;
+}
+
+/* Retains the first num_unicodes codepoints from the font's cmap. */
+static void
+subset_input_add_unicodes (hb_subset_input_t *input, hb_face_t *face,
+			   unsigned num_unicodes)
+{
+  hb_set_t *all_unicodes = hb_set_create ();
+  hb_face_collect_unicodes (face, all_unicodes);
+
+  hb_set_t *unicodes = hb_subset_input_unicode_set (input);
+  hb_codepoint_t u = HB_SET_VALUE_INVALID;
+  while (num_unicodes-- && hb_set_next (all_unicodes, &u))
+    hb_set_add (unicodes, u);
+
+  hb_set_destroy (all_unicodes);
+}
+
+static void
+subset_run (benchmark::State &state, hb_face_t *face, hb_subset_input_t *input)
+{
+  for (auto _ : state)
+  {
+    hb_face_t *subset = hb_subset (face, input);
+    hb_face_destroy (subset);
+  }
+}
+
+/* Whole-font subset; range (0) is the number of codepoints to retain and
+ * range (1) toggles retain-gids. */
+static void subset (benchmark::State &state, const char *font_path)
+{
+  hb_face_t *face = subset_source_face (font_path);
+  hb_subset_input_t *input = hb_subset_input_create_or_fail ();
+  assert (input);
+
+  subset_input_add_unicodes (input, face, state.range (0));
+  hb_subset_input_set_retain_gids (input, state.range (1));
+
+  subset_run (state, face, input);
+
+  hb_subset_input_destroy (input);
+  hb_face_destroy (face);
+}
+
+/* Subsets a single table by dropping all the others; with table set to
+ * nullptr every table is dropped, which times the bare plan.  A table's
+ * time includes the plan work only it needs, like the GSUB closure.
+ * Tables that share a subsetter come along with the one named: loca and
+ * head with glyf, hhea with hmtx.
+ *
+ * The offset-overflow repacker, hb_resolve_overflows(), only ever runs on
+ * GSUB and GPOS, and only when they overflow.  NotoNastaliqUrdu's GSUB
+ * does; compare it against Amiri's to see the repacking cost. */
+static void subset_table (benchmark::State &state, const char *font_path,
+			  const char *table)
+{
+  hb_face_t *face = subset_source_face (font_path);
+  hb_subset_input_t *input = hb_subset_input_create_or_fail ();
+  assert (input);
+
+  subset_input_add_unicodes (input, face, 1000);
+
+  hb_tag_t keep = table ? hb_tag_from_string (table, -1) : HB_TAG_NONE;
+  hb_set_t *drop_tables = hb_subset_input_drop_tables_set (input);
+  hb_tag_t table_tags[32];
+  unsigned offset = 0, num_tables = sizeof (table_tags) / sizeof (table_tags[0]);
+  while ((hb_face_get_table_tags (face, offset, &num_tables, table_tags), num_tables))
+  {
+    for (unsigned i = 0; i < num_tables; i++)
+      if (table_tags[i] != keep)
+	hb_set_add (drop_tables, table_tags[i]);
+    offset += num_tables;
+  }
+  assert (!keep || !hb_set_has (drop_tables, keep));
+
+  subset_run (state, face, input);
+
+  hb_subset_input_destroy (input);
+  hb_face_destroy (face);
+}
+
+#define SUBSET_BENCHMARK(name, font_path) \
+  BENCHMARK_CAPTURE (subset, name, font_path) \
+    ->RangeMultiplier (10)->Ranges ({{10, 10000}, {false, true}}) \
+    ->Unit (benchmark::kMillisecond)
+
+SUBSET_BENCHMARK (Amiri, "perf/fonts/Amiri-Regular.ttf");
+SUBSET_BENCHMARK (NotoNastaliqUrdu, "perf/fonts/NotoNastaliqUrdu-Regular.ttf");
+SUBSET_BENCHMARK (NotoSansDevanagari, "perf/fonts/NotoSansDevanagari-Regular.ttf");
+SUBSET_BENCHMARK (Roboto, "perf/fonts/Roboto-Regular.ttf");
+SUBSET_BENCHMARK (Mplus1p, TEST_FONTS_PATH "Mplus1p-Regular.ttf");
+SUBSET_BENCHMARK (SourceSansPro, TEST_FONTS_PATH "SourceSansPro-Regular.otf");
+
+#define SUBSET_TABLE_BENCHMARK(name, font_path, table) \
+  BENCHMARK_CAPTURE (subset_table, name - table, font_path, #table) \
+    ->Unit (benchmark::kMillisecond)
+#define SUBSET_PLAN_BENCHMARK(name, font_path) \
+  BENCHMARK_CAPTURE (subset_table, name - plan, font_path, nullptr) \
+    ->Unit (benchmark::kMillisecond)
+
+SUBSET_PLAN_BENCHMARK (Amiri, "perf/fonts/Amiri-Regular.ttf");
+SUBSET_TABLE_BENCHMARK (Amiri, "perf/fonts/Amiri-Regular.ttf", glyf);
+SUBSET_TABLE_BENCHMARK (Amiri, "perf/fonts/Amiri-Regular.ttf", hmtx);
+SUBSET_TABLE_BENCHMARK (Amiri, "perf/fonts/Amiri-Regular.ttf", cmap);
+SUBSET_TABLE_BENCHMARK (Amiri, "perf/fonts/Amiri-Regular.ttf", post);
+SUBSET_TABLE_BENCHMARK (Amiri, "perf/fonts/Amiri-Regular.ttf", name);
+SUBSET_TABLE_BENCHMARK (Amiri, "perf/fonts/Amiri-Regular.ttf", GDEF);
+SUBSET_TABLE_BENCHMARK (Amiri, "perf/fonts/Amiri-Regular.ttf", GSUB);
+SUBSET_TABLE_BENCHMARK (Amiri, "perf/fonts/Amiri-Regular.ttf", GPOS);
+
+SUBSET_PLAN_BENCHMARK (NotoNastaliqUrdu, "perf/fonts/NotoNastaliqUrdu-Regular.ttf");
+SUBSET_TABLE_BENCHMARK (NotoNastaliqUrdu, "perf/fonts/NotoNastaliqUrdu-Regular.ttf", glyf);
+SUBSET_TABLE_BENCHMARK (NotoNastaliqUrdu, "perf/fonts/NotoNastaliqUrdu-Regular.ttf", GSUB);
+SUBSET_TABLE_BENCHMARK (NotoNastaliqUrdu, "perf/fonts/NotoNastaliqUrdu-Regular.ttf", GPOS);
+
+SUBSET_PLAN_BENCHMARK (Mplus1p, TEST_FONTS_PATH "Mplus1p-Regular.ttf");
+SUBSET_TABLE_BENCHMARK (Mplus1p, TEST_FONTS_PATH "Mplus1p-Regular.ttf", glyf);
+SUBSET_TABLE_BENCHMARK (Mplus1p, TEST_FONTS_PATH "Mplus1p-Regular.ttf", hmtx);
+SUBSET_TABLE_BENCHMARK (Mplus1p, TEST_FONTS_PATH "Mplus1p-Regular.ttf", cmap);
+SUBSET_TABLE_BENCHMARK (Mplus1p, TEST_FONTS_PATH "Mplus1p-Regular.ttf", post);
+SUBSET_TABLE_BENCHMARK (Mplus1p, TEST_FONTS_PATH "Mplus1p-Regular.ttf", GSUB);
+SUBSET_TABLE_BENCHMARK (Mplus1p, TEST_FONTS_PATH "Mplus1p-Regular.ttf", GPOS);
+
+SUBSET_PLAN_BENCHMARK (SourceSansPro, TEST_FONTS_PATH "SourceSansPro-Regular.otf");
+SUBSET_TABLE_BENCHMARK (SourceSansPro, TEST_FONTS_PATH "SourceSansPro-Regular.otf", CFF);
+SUBSET_TABLE_BENCHMARK (SourceSansPro, TEST_FONTS_PATH "SourceSansPro-Regular.otf", hmtx);
+SUBSET_TABLE_BENCHMARK (SourceSansPro, TEST_FONTS_PATH "SourceSansPro-Regular.otf", cmap);
+SUBSET_TABLE_BENCHMARK (SourceSansPro, TEST_FONTS_PATH "SourceSansPro-Regular.otf", GSUB);
+SUBSET_TABLE_BENCHMARK (SourceSansPro, TEST_FONTS_PATH "SourceSansPro-Regular.otf", GPOS);
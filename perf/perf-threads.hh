@@ -0,0 +1,148 @@
+#include "benchmark/benchmark.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "hb.h"
+
+enum font_sharing_t { SHARED_FONT, PER_THREAD_FONT };
+
+static hb_face_t *shared_face;
+static hb_font_t *shared_font;
+
+static hb_face_t *
+create_face (const char *font_path)
+{
+  hb_blob_t *blob = hb_blob_create_from_file_or_fail (font_path);
+  assert (blob);
+  hb_face_t *face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  return face;
+}
+
+static void
+shape_once (hb_font_t *font, hb_buffer_t *buf,
+	    const char *text, unsigned text_length,
+	    hb_direction_t direction, hb_script_t script)
+{
+  hb_buffer_add_utf8 (buf, text, text_length, 0, -1);
+  hb_buffer_set_direction (buf, direction);
+  hb_buffer_set_script (buf, script);
+  hb_shape (font, buf, nullptr, 0);
+  hb_buffer_clear_contents (buf);
+}
+
+/* Steady-state throughput of N threads shaping with one face.  Compare
+ * items_per_second across thread counts to see how shaping scales. */
+static void shape_threads (benchmark::State &state, font_sharing_t sharing,
+			   const char *text_path,
+			   hb_direction_t direction, hb_script_t script,
+			   const char *font_path)
+{
+  /* The benchmark loop starts and ends with a barrier, so thread 0 can
+   * set up and tear down the shared objects outside of it. */
+  if (state.thread_index == 0)
+  {
+    shared_face = create_face (font_path);
+    shared_font = hb_font_create (shared_face);
+  }
+
+  hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (text_path);
+  assert (text_blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (text_blob, &text_length);
+
+  hb_font_t *font = nullptr;
+  hb_buffer_t *buf = hb_buffer_create ();
+  for (auto _ : state)
+  {
+    /* Only safe to look at shared_font once past the barrier. */
+    if (!font)
+      font = sharing == SHARED_FONT ? hb_font_reference (shared_font)
+				    : hb_font_create (shared_face);
+    shape_once (font, buf, text, text_length, direction, script);
+  }
+  state.SetItemsProcessed (state.iterations ());
+  hb_buffer_destroy (buf);
+  hb_font_destroy (font);
+  hb_blob_destroy (text_blob);
+
+  if (state.thread_index == 0)
+  {
+    hb_font_destroy (shared_font);
+    hb_face_destroy (shared_face);
+  }
+}
+
+/* Wall time for N threads to each finish their first shape on a freshly
+ * created face.  All table loads, accelerators and the shape plan are
+ * created lazily, so this is where contention in the lazy loaders and
+ * the shape-plan cache shows up. */
+static void first_shape_threads (benchmark::State &state, font_sharing_t sharing,
+				 const char *text_path,
+				 hb_direction_t direction, hb_script_t script,
+				 const char *font_path)
+{
+  unsigned num_threads = state.range (0);
+
+  hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (text_path);
+  assert (text_blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (text_blob, &text_length);
+
+  for (auto _ : state)
+  {
+    state.PauseTiming ();
+    hb_face_t *face = create_face (font_path);
+    hb_font_t *font = hb_font_create (face);
+    std::atomic<bool> go (false);
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < num_threads; i++)
+      threads.push_back (std::thread ([&] ()
+      {
+	hb_font_t *thread_font = sharing == SHARED_FONT ? hb_font_reference (font)
+							: hb_font_create (face);
+	hb_buffer_t *buf = hb_buffer_create ();
+	while (!go.load (std::memory_order_acquire))
+	  std::this_thread::yield ();
+	shape_once (thread_font, buf, text, text_length, direction, script);
+	hb_buffer_destroy (buf);
+	hb_font_destroy (thread_font);
+      }));
+    state.ResumeTiming ();
+
+    go.store (true, std::memory_order_release);
+    for (auto &thread : threads)
+      thread.join ();
+
+    state.PauseTiming ();
+    hb_font_destroy (font);
+    hb_face_destroy (face);
+    state.ResumeTiming ();
+  }
+
+  hb_blob_destroy (text_blob);
+}
+
+BENCHMARK_CAPTURE (shape_threads, fa-monologue.txt - Amiri shared font,
+		   SHARED_FONT, "perf/texts/fa-monologue.txt",
+		   HB_DIRECTION_RTL, HB_SCRIPT_ARABIC,
+		   "perf/fonts/Amiri-Regular.ttf")
+  ->ThreadRange (1, 8)->UseRealTime ();
+BENCHMARK_CAPTURE (shape_threads, fa-monologue.txt - Amiri per-thread font,
+		   PER_THREAD_FONT, "perf/texts/fa-monologue.txt",
+		   HB_DIRECTION_RTL, HB_SCRIPT_ARABIC,
+		   "perf/fonts/Amiri-Regular.ttf")
+  ->ThreadRange (1, 8)->UseRealTime ();
+
+BENCHMARK_CAPTURE (first_shape_threads, hi-udhr.txt - NotoSansDevanagari shared font,
+		   SHARED_FONT, "perf/texts/hi-udhr.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_DEVANAGARI,
+		   "perf/fonts/NotoSansDevanagari-Regular.ttf")
+  ->RangeMultiplier (2)->Range (1, 8)->UseRealTime ()->Unit (benchmark::kMicrosecond);
+BENCHMARK_CAPTURE (first_shape_threads, hi-udhr.txt - NotoSansDevanagari per-thread font,
+		   PER_THREAD_FONT, "perf/texts/hi-udhr.txt",
+		   HB_DIRECTION_LTR, HB_SCRIPT_DEVANAGARI,
+		   "perf/fonts/NotoSansDevanagari-Regular.ttf")
+  ->RangeMultiplier (2)->Range (1, 8)->UseRealTime ()->Unit (benchmark::kMicrosecond);
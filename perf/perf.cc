@@ -5,6 +5,11 @@
 #endif
 
 #include "perf-shaping.hh"
+#include "perf-threads.hh"
+#include "perf-subset.hh"
+#ifdef HB_EXPERIMENTAL_API
+#include "perf-batch.hh"
+#endif
 #ifdef HAVE_FREETYPE
 enum backend_t { HARFBUZZ, FREETYPE, TTF_PARSER };
 #include "perf-extents.hh"
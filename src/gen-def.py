@@ -36,7 +36,35 @@ hb_draw_funcs_set_cubic_to_func
 hb_draw_funcs_set_line_to_func
 hb_draw_funcs_set_move_to_func
 hb_draw_funcs_set_quadratic_to_func
+hb_glyph_path_verb_t
+hb_glyph_path_t
+hb_glyph_path_get_empty
+hb_glyph_path_reference
+hb_glyph_path_destroy
+hb_glyph_path_set_user_data
+hb_glyph_path_get_user_data
+hb_glyph_path_get_verbs
+hb_glyph_path_get_points
+hb_glyph_path_draw
+hb_glyph_path_draw_transformed
+hb_font_get_glyph_path
 hb_style_get_value
+hb_subset_task_func_t
+hb_subset_parallel_for_func_t
+hb_subset_input_set_parallel_for_func
+hb_shape_batch_run_t
+hb_shape_batch_utf8
+hb_shape_batch_utf16
+hb_shape_batch_utf32
+hb_shape_cache_t
+hb_shape_cache_create
+hb_shape_cache_get_empty
+hb_shape_cache_reference
+hb_shape_cache_destroy
+hb_shape_cache_set_user_data
+hb_shape_cache_get_user_data
+hb_shape_cache_clear
+hb_shape_cached
 hb_font_get_var_coords_design""".splitlines ()
 	symbols = [x for x in symbols if x not in experimental_symbols]
 symbols = "\n".join (symbols)
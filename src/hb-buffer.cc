@@ -181,6 +181,16 @@ hb_buffer_t::shift_forward (unsigned int count)
   assert (have_output);
   if (unlikely (!ensure (len + count))) return false;
 
+  /* Shift by as much as we move, if the allocation has room for it,
+   * so that a run of rewinds moves the rest of the buffer O(1) times
+   * per rewound glyph instead of once per rewind.  The extra never
+   * reaches past the current end, so it only leaves stale copies of
+   * glyphs behind, not the cleared slots below.  The allocation can
+   * be larger than max_len; len must not grow past it either way. */
+  unsigned int limit = hb_min (allocated - 1, max_len);
+  if (len - idx > count && len + count < limit)
+    count += hb_min (len - idx - count, limit - (len + count));
+
   memmove (info + idx + count, info + idx, (len - idx) * sizeof (info[0]));
   if (idx + count > len)
   {
@@ -359,12 +369,11 @@ hb_buffer_t::move_to (unsigned int i)
     /* This will blow in our face if memory allocation fails later
      * in this same lookup...
      *
-     * We used to shift with extra 32 items, instead of the 0 below.
-     * But that would leave empty slots in the buffer in case of allocation
-     * failures.  Setting to zero for now to avoid other problems (see
-     * comments in shift_forward().  This can cause O(N^2) behavior more
-     * severely than adding 32 empty slots can... */
-    if (unlikely (idx < count && !shift_forward (count + 0))) return false;
+     * We used to shift with extra 32 items.  But that would leave empty
+     * slots in the buffer in case of allocation failures; see comments
+     * in shift_forward(), which now adds its own slack where that is
+     * safe. */
+    if (unlikely (idx < count && !shift_forward (count - idx))) return false;
 
     assert (idx >= count);
 
@@ -476,7 +485,7 @@ void
 hb_buffer_t::merge_out_clusters (unsigned int start,
 				 unsigned int end)
 {
-  if (cluster_level == HB_BUFFER_CLUSTER_LEVEL_CHARACTERS)
+  if (cluster_level == HB_BUFFER_CLUSTER_LEVEL_CHARACTERS || !tracks_clusters ())
     return;
 
   if (unlikely (end - start < 2))
@@ -508,6 +517,12 @@ hb_buffer_t::delete_glyph ()
 {
   /* The logic here is duplicated in hb_ot_hide_default_ignorables(). */
 
+  if (!tracks_clusters ())
+  {
+    skip_glyph ();
+    return;
+  }
+
   unsigned int cluster = info[idx].cluster;
   if (idx + 1 < len && cluster == info[idx + 1].cluster)
   {
@@ -549,6 +564,9 @@ hb_buffer_t::unsafe_to_break_impl (unsigned int start, unsigned int end)
 void
 hb_buffer_t::unsafe_to_break_from_outbuffer (unsigned int start, unsigned int end)
 {
+  if (!tracks_clusters ())
+    return;
+
   if (!have_output)
   {
     unsafe_to_break_impl (start, end);
@@ -296,6 +296,15 @@ hb_buffer_guess_segment_properties (hb_buffer_t *buffer);
  *                      flag indicating that a dotted circle should
  *                      not be inserted in the rendering of incorrect
  *                      character sequences (such at <0905 093E>). Since: 2.4
+ * @HB_BUFFER_FLAG_SKIP_CLUSTER_TRACKING:
+ *                      flag indicating that the output will not be mapped
+ *                      back to the text, so cluster values need not be
+ *                      maintained: clusters are not merged, and the
+ *                      #HB_GLYPH_FLAG_UNSAFE_TO_BREAK glyph flag is not
+ *                      set.  Output glyphs and positions are unaffected.
+ *                      Cluster values come out as in
+ *                      @HB_BUFFER_CLUSTER_LEVEL_CHARACTERS, except that they
+ *                      may be out of order.  Since: REPLACEME
  *
  * Flags for #hb_buffer_t.
  *
@@ -307,7 +316,8 @@ typedef enum { /*< flags >*/
   HB_BUFFER_FLAG_EOT				= 0x00000002u, /* End-of-text */
   HB_BUFFER_FLAG_PRESERVE_DEFAULT_IGNORABLES	= 0x00000004u,
   HB_BUFFER_FLAG_REMOVE_DEFAULT_IGNORABLES	= 0x00000008u,
-  HB_BUFFER_FLAG_DO_NOT_INSERT_DOTTED_CIRCLE	= 0x00000010u
+  HB_BUFFER_FLAG_DO_NOT_INSERT_DOTTED_CIRCLE	= 0x00000010u,
+  HB_BUFFER_FLAG_SKIP_CLUSTER_TRACKING		= 0x00000020u
 } hb_buffer_flags_t;
 
 HB_EXTERN void
@@ -308,9 +308,14 @@ struct hb_buffer_t
   HB_INTERNAL void set_masks (hb_mask_t value, hb_mask_t mask,
 			      unsigned int cluster_start, unsigned int cluster_end);
 
+  /* False with HB_BUFFER_FLAG_SKIP_CLUSTER_TRACKING, in which case
+   * clusters are not merged and unsafe-to-break is not tracked. */
+  bool tracks_clusters () const
+  { return !(flags & HB_BUFFER_FLAG_SKIP_CLUSTER_TRACKING); }
+
   void merge_clusters (unsigned int start, unsigned int end)
   {
-    if (end - start < 2)
+    if (end - start < 2 || !tracks_clusters ())
       return;
     merge_clusters_impl (start, end);
   }
@@ -322,7 +327,7 @@ struct hb_buffer_t
   void unsafe_to_break (unsigned int start,
 			unsigned int end)
   {
-    if (end - start < 2)
+    if (end - start < 2 || !tracks_clusters ())
       return;
     unsafe_to_break_impl (start, end);
   }
@@ -449,7 +454,7 @@ struct hb_buffer_t
       }
   }
 
-  void unsafe_to_break_all () { unsafe_to_break_impl (0, len); }
+  void unsafe_to_break_all () { unsafe_to_break (0, len); }
   void safe_to_break_all ()
   {
     for (unsigned int i = 0; i < len; i++)
@@ -30,6 +30,29 @@
 #include "hb.hh"
 
 
+/* Hit / miss counters for the caches below.  Only updated when
+ * HB_DEBUG_CACHE is enabled, and reported through DEBUG_MSG. */
+
+struct hb_cache_stats_t
+{
+  void init () { hits.set_relaxed (0); misses.set_relaxed (0); }
+  void fini () {}
+
+  void hit () const { if (HB_DEBUG_CACHE) hits.inc (); }
+  void miss () const { if (HB_DEBUG_CACHE) misses.inc (); }
+
+  void report (const void *obj HB_UNUSED, const char *name HB_UNUSED) const
+  {
+    DEBUG_MSG (CACHE, obj, "%s: %d hits, %d misses",
+	       name, hits.get_relaxed (), misses.get_relaxed ());
+  }
+
+  private:
+  mutable hb_atomic_int_t hits;
+  mutable hb_atomic_int_t misses;
+};
+
+
 /* Implements a lockfree cache for int->int functions. */
 
 template <unsigned int key_bits, unsigned int value_bits, unsigned int cache_bits>
@@ -39,8 +62,8 @@ struct hb_cache_t
   static_assert ((key_bits + value_bits - cache_bits <= 8 * sizeof (hb_atomic_int_t)), "");
   static_assert (sizeof (hb_atomic_int_t) == sizeof (unsigned int), "");
 
-  void init () { clear (); }
-  void fini () {}
+  void init () { clear (); stats.init (); }
+  void fini () { stats.fini (); }
 
   void clear ()
   {
@@ -52,10 +75,16 @@ struct hb_cache_t
   {
     unsigned int k = key & ((1u<<cache_bits)-1);
     unsigned int v = values[k].get_relaxed ();
-    if ((key_bits + value_bits - cache_bits == 8 * sizeof (hb_atomic_int_t) && v == (unsigned int) -1) ||
+    /* Keys that don't fit are never set(); they could match an empty slot. */
+    if (unlikely (key >> key_bits) ||
+	(key_bits + value_bits - cache_bits == 8 * sizeof (hb_atomic_int_t) && v == (unsigned int) -1) ||
 	(v >> value_bits) != (key >> cache_bits))
+    {
+      stats.miss ();
       return false;
+    }
     *value = v & ((1u<<value_bits)-1);
+    stats.hit ();
     return true;
   }
 
@@ -69,6 +98,8 @@ struct hb_cache_t
     return true;
   }
 
+  hb_cache_stats_t stats;
+
   private:
   hb_atomic_int_t values[1u<<cache_bits];
 };
@@ -28,6 +28,7 @@
 
 #include "hb.hh"
 #include "hb-cff-interp-common.hh"
+#include "hb-cache.hh"
 
 namespace CFF {
 
@@ -906,6 +907,329 @@ struct cs_interpreter_t : interpreter_t<ENV>
   typedef interpreter_t<ENV> SUPER;
 };
 
+/* A charstring reduced to its outline: the absolute points, in font units,
+ * of the moveto, lineto and curveto operators it executes, subroutines
+ * expanded, followed by the arguments of its seac if it has one.  Stored as
+ * a byte stream of one opcode byte followed by its coordinates, as 16-bit
+ * integers when all of them fit and as doubles otherwise.  Replaying it
+ * gives the very points interpreting the charstring would. */
+struct cs_path_t
+{
+  enum op_t {
+    MOVETO,
+    LINETO,
+    CURVETO,
+    SEAC
+  };
+  enum { SHORT_COORDS = 0x80 };
+
+  struct seac_t
+  {
+    point_t		delta;
+    hb_codepoint_t	base;
+    hb_codepoint_t	accent;
+  };
+
+  /* Feeds the points to the move_to(), line_to() and cubic_to() methods of
+   * @sink.  Returns true if the charstring ends in a seac, stored in @seac. */
+  template <typename SINK>
+  bool replay (SINK &sink, seac_t &seac) const
+  {
+    const uint8_t *p = data;
+    const uint8_t *end = data + length;
+    point_t pts[3];
+    while (p < end)
+    {
+      unsigned op = *p & ~SHORT_COORDS;
+      bool short_coords = *p++ & SHORT_COORDS;
+      switch (op)
+      {
+      case MOVETO:
+	p = fetch_points (p, pts, 1, short_coords);
+	sink.move_to (pts[0]);
+	break;
+      case LINETO:
+	p = fetch_points (p, pts, 1, short_coords);
+	sink.line_to (pts[0]);
+	break;
+      case CURVETO:
+	p = fetch_points (p, pts, 3, short_coords);
+	sink.cubic_to (pts[0], pts[1], pts[2]);
+	break;
+      case SEAC:
+	p = fetch_points (p, &seac.delta, 1, short_coords);
+	memcpy (&seac.base, p, sizeof (seac.base));
+	memcpy (&seac.accent, p + sizeof (seac.base), sizeof (seac.accent));
+	return true;
+      }
+    }
+    return false;
+  }
+
+  private:
+  static const uint8_t *fetch_points (const uint8_t *p, point_t *pts, unsigned count, bool short_coords)
+  {
+    for (unsigned i = 0; i < count; i++)
+    {
+      p = fetch_coord (p, pts[i].x, short_coords);
+      p = fetch_coord (p, pts[i].y, short_coords);
+    }
+    return p;
+  }
+
+  static const uint8_t *fetch_coord (const uint8_t *p, number_t &v, bool short_coords)
+  {
+    if (short_coords)
+    {
+      int16_t i;
+      memcpy (&i, p, sizeof (i));
+      v.set_int (i);
+      return p + sizeof (i);
+    }
+    double d;
+    memcpy (&d, p, sizeof (d));
+    v.set_real (d);
+    return p + sizeof (d);
+  }
+
+  public:
+  unsigned int	length;
+  uint8_t	data[HB_VAR_ARRAY];
+};
+
+/* Records the path of a charstring while it is interpreted, as path
+ * parameter of cs_path_procs_build_t. */
+struct cs_path_builder_t
+{
+  void init () { data.init (); }
+  void fini () { data.fini (); }
+
+  void move_to (const point_t &p) { push_op (cs_path_t::MOVETO, &p, 1); }
+  void line_to (const point_t &p) { push_op (cs_path_t::LINETO, &p, 1); }
+  void cubic_to (const point_t &p1, const point_t &p2, const point_t &p3)
+  {
+    const point_t pts[3] = {p1, p2, p3};
+    push_op (cs_path_t::CURVETO, pts, 3);
+  }
+  void seac (const point_t &delta, hb_codepoint_t base, hb_codepoint_t accent)
+  {
+    uint8_t *p = push_op (cs_path_t::SEAC, &delta, 1, sizeof (base) + sizeof (accent));
+    if (unlikely (!p)) return;
+    memcpy (p, &base, sizeof (base));
+    memcpy (p + sizeof (base), &accent, sizeof (accent));
+  }
+
+  bool in_error () const { return data.in_error (); }
+
+  hb_vector_t<uint8_t> data;
+
+  private:
+  /* Returns where the @extra bytes following the coordinates go. */
+  uint8_t *push_op (unsigned op, const point_t *pts, unsigned count, unsigned extra = 0)
+  {
+    bool short_coords = true;
+    for (unsigned i = 0; i < count; i++)
+      short_coords = short_coords && is_short (pts[i].x) && is_short (pts[i].y);
+
+    unsigned size = 1 + 2 * count * (short_coords ? sizeof (int16_t) : sizeof (double)) + extra;
+    if (unlikely (!data.alloc (data.length + size))) return nullptr;
+    uint8_t *p = data.arrayZ + data.length;
+    data.length += size;
+
+    *p++ = op | (short_coords ? cs_path_t::SHORT_COORDS : 0);
+    for (unsigned i = 0; i < count; i++)
+    {
+      p = put_coord (p, pts[i].x, short_coords);
+      p = put_coord (p, pts[i].y, short_coords);
+    }
+    return p;
+  }
+
+  static uint8_t *put_coord (uint8_t *p, const number_t &v, bool short_coords)
+  {
+    if (short_coords)
+    {
+      int16_t i = (int16_t) v.to_real ();
+      memcpy (p, &i, sizeof (i));
+      return p + sizeof (i);
+    }
+    double d = v.to_real ();
+    memcpy (p, &d, sizeof (d));
+    return p + sizeof (d);
+  }
+
+  /* Compares bits rather than values to keep the sign of zero. */
+  static bool is_short (const number_t &v)
+  {
+    double d = v.to_real ();
+    if (!(d >= INT16_MIN && d <= INT16_MAX)) return false;
+    double r = (int16_t) d;
+    return 0 == memcmp (&r, &d, sizeof (d));
+  }
+};
+
+template <typename ENV, typename PARAM>
+struct cs_path_procs_build_t : path_procs_t<cs_path_procs_build_t<ENV, PARAM>, ENV, PARAM>
+{
+  static void moveto (ENV &env, PARAM& param, const point_t &pt)
+  {
+    param.move_to (pt);
+    env.moveto (pt);
+  }
+
+  static void line (ENV &env, PARAM& param, const point_t &pt1)
+  {
+    param.line_to (pt1);
+    env.moveto (pt1);
+  }
+
+  static void curve (ENV &env, PARAM& param, const point_t &pt1, const point_t &pt2, const point_t &pt3)
+  {
+    param.cubic_to (pt1, pt2, pt3);
+    env.moveto (pt3);
+  }
+};
+
+/* Lockfree cache of the paths of the glyphs of a CFF or CFF2 font, indexed
+ * by glyph id.  The table is allocated on first use.  Filled slots are never
+ * replaced until the cache is flushed, so readers never see a path freed
+ * under them.  Caches whose paths depend on the variation coordinates of a
+ * font are flushed through sync() the first time they are used after the
+ * coordinates change, which needs that no other thread is using the cache
+ * at the time; that holds as the coordinates may only be changed while the
+ * font is not in use.
+ *
+ * The bytes of the table and paths are counted against a budget, which the
+ * cache of a face's default instance shares with those of all the fonts of
+ * the face, so that variable fonts don't each add MAX_BYTES. */
+struct cs_path_cache_t
+{
+  /* Stop adding paths once the caches sharing a budget hold this many bytes. */
+  static constexpr unsigned MAX_BYTES = 16u << 20;
+
+  void init (hb_atomic_int_t *budget_ = nullptr)
+  {
+    table.set_relaxed (nullptr);
+    num_slots = 0;
+    bytes.set_relaxed (0);
+    budget.set_relaxed (budget_);
+    flushing.init ();
+    serial.set_relaxed (0);
+    stats.init ();
+  }
+  void fini ()
+  {
+    clear ();
+    stats.fini ();
+  }
+
+  /* Caches are unusable until they have a budget; setting one that is
+   * already set is a no-op. */
+  void set_budget (hb_atomic_int_t *budget_)
+  { if (unlikely (!budget.get_relaxed ())) budget.cmpexch (nullptr, budget_); }
+
+  bool is_full () const
+  {
+    const hb_atomic_int_t *b = budget.get_relaxed ();
+    return !b || (unsigned) b->get_relaxed () >= MAX_BYTES;
+  }
+
+  /* Returns false if the cache cannot be used right now. */
+  bool sync (unsigned font_serial)
+  {
+    if (likely ((unsigned) serial.get () == font_serial))
+      return true;
+
+    if (!flushing.cmpexch (nullptr, this))
+      return false;
+    /* Someone else may have flushed while we were looking. */
+    if ((unsigned) serial.get () != font_serial)
+    {
+      clear ();
+      serial.set (font_serial);
+    }
+    flushing.set_relaxed (nullptr);
+    return true;
+  }
+
+  const cs_path_t *get (hb_codepoint_t gid) const
+  {
+    const hb_atomic_ptr_t<cs_path_t> *slots = table.get ();
+    const cs_path_t *path = slots ? slots[gid].get () : nullptr;
+    if (path) stats.hit (); else stats.miss ();
+    return path;
+  }
+
+  /* Returns the path now cached for @gid, or nullptr if it could not be
+   * added. */
+  const cs_path_t *set (hb_codepoint_t gid, unsigned num_glyphs, const cs_path_builder_t &builder)
+  {
+    if (unlikely (builder.in_error ())) return nullptr;
+    hb_atomic_int_t *b = budget.get_relaxed ();
+    if (unlikely (!b)) return nullptr;
+    unsigned size = offsetof (cs_path_t, data) + builder.data.length;
+    hb_atomic_ptr_t<cs_path_t> *slots = table.get ();
+    unsigned table_size = slots ? 0 : num_glyphs * sizeof (slots[0]);
+    if ((unsigned) b->get_relaxed () + table_size + size > MAX_BYTES) return nullptr;
+
+    if (unlikely (!slots))
+    {
+      slots = (hb_atomic_ptr_t<cs_path_t> *) hb_calloc (num_glyphs, sizeof (slots[0]));
+      if (unlikely (!slots)) return nullptr;
+      if (table.cmpexch (nullptr, slots))
+      {
+	num_slots = num_glyphs;
+	charge (b, table_size);
+      }
+      else
+      {
+	hb_free (slots);
+	slots = table.get ();
+      }
+    }
+
+    cs_path_t *path = (cs_path_t *) hb_malloc (size);
+    if (unlikely (!path)) return nullptr;
+    path->length = builder.data.length;
+    if (builder.data.length)
+      memcpy (path->data, builder.data.arrayZ, builder.data.length);
+    if (!slots[gid].cmpexch (nullptr, path))
+    {
+      hb_free (path);
+      return slots[gid].get ();
+    }
+    charge (b, size);
+    return path;
+  }
+
+  hb_cache_stats_t stats;
+
+  private:
+  void charge (hb_atomic_int_t *b, int size)
+  {
+    (void) hb_atomic_int_impl_add (&bytes.v, size);
+    (void) hb_atomic_int_impl_add (&b->v, size);
+  }
+
+  void clear ()
+  {
+    hb_atomic_ptr_t<cs_path_t> *slots = table.get_relaxed ();
+    if (!slots) return;
+    for (unsigned i = 0; i < num_slots; i++)
+      hb_free (slots[i].get_relaxed ());
+    hb_free (slots);
+    table.set_relaxed (nullptr);
+    charge (budget.get_relaxed (), -bytes.get_relaxed ());
+  }
+
+  hb_atomic_ptr_t<hb_atomic_ptr_t<cs_path_t>> table;
+  unsigned num_slots; /* Written by whoever allocates the table. */
+  hb_atomic_int_t bytes; /* Ours, also counted in *budget. */
+  hb_atomic_ptr_t<hb_atomic_int_t> budget;
+  hb_atomic_ptr_t<void> flushing;
+  hb_atomic_int_t serial;
+};
+
 } /* namespace CFF */
 
 #endif /* HB_CFF_INTERP_CS_COMMON_HH */
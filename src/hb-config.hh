@@ -74,6 +74,7 @@
 #define HB_NO_NAME
 #define HB_NO_OPEN
 #define HB_NO_SETLOCALE
+#define HB_NO_OT_FONT_EXTENTS_CACHE
 #define HB_NO_OT_FONT_GLYPH_NAMES
 #define HB_NO_OT_SHAPE_FRACTIONS
 #define HB_NO_STYLE
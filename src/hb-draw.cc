@@ -257,5 +257,506 @@ hb_font_draw_glyph (hb_font_t *font, hb_codepoint_t glyph,
   return false;
 }
 
+
+/*
+ * hb_glyph_path_t
+ */
+
+static void
+_record (void *user_data, hb_glyph_path_verb_t verb,
+	 const hb_position_t *values, unsigned count)
+{
+  hb_glyph_path_t *path = (hb_glyph_path_t *) user_data;
+  unsigned old_length = path->points.length;
+  /* On failure the path is in error and gets dropped. */
+  if (unlikely (!path->verbs.resize (path->verbs.length + 1) ||
+		!path->points.resize (old_length + count)))
+    return;
+  path->verbs.tail () = verb;
+  for (unsigned i = 0; i < count; i++)
+    path->points.arrayZ[old_length + i] = values[i];
+}
+
+static void
+_record_move_to (hb_position_t to_x, hb_position_t to_y, void *user_data)
+{
+  hb_position_t values[] = {to_x, to_y};
+  _record (user_data, HB_GLYPH_PATH_VERB_MOVE_TO, values, ARRAY_LENGTH (values));
+}
+
+static void
+_record_line_to (hb_position_t to_x, hb_position_t to_y, void *user_data)
+{
+  hb_position_t values[] = {to_x, to_y};
+  _record (user_data, HB_GLYPH_PATH_VERB_LINE_TO, values, ARRAY_LENGTH (values));
+}
+
+static void
+_record_quadratic_to (hb_position_t control_x, hb_position_t control_y,
+		      hb_position_t to_x, hb_position_t to_y,
+		      void *user_data)
+{
+  hb_position_t values[] = {control_x, control_y, to_x, to_y};
+  _record (user_data, HB_GLYPH_PATH_VERB_QUADRATIC_TO, values, ARRAY_LENGTH (values));
+}
+
+static void
+_record_cubic_to (hb_position_t control1_x, hb_position_t control1_y,
+		  hb_position_t control2_x, hb_position_t control2_y,
+		  hb_position_t to_x, hb_position_t to_y,
+		  void *user_data)
+{
+  hb_position_t values[] = {control1_x, control1_y, control2_x, control2_y, to_x, to_y};
+  _record (user_data, HB_GLYPH_PATH_VERB_CUBIC_TO, values, ARRAY_LENGTH (values));
+}
+
+static void
+_record_close_path (void *user_data)
+{
+  _record (user_data, HB_GLYPH_PATH_VERB_CLOSE_PATH, nullptr, 0);
+}
+
+static const hb_draw_funcs_t _hb_glyph_path_recorder =
+{
+  HB_OBJECT_HEADER_STATIC,
+
+  _record_move_to,
+  _record_line_to,
+  _record_quadratic_to,
+  true, /* is_quadratic_to_set */
+  _record_cubic_to,
+  _record_close_path,
+};
+
+struct hb_glyph_path_identity_t
+{
+  void operator () (hb_position_t &x HB_UNUSED, hb_position_t &y HB_UNUSED) const {}
+};
+
+struct hb_glyph_path_affine_t
+{
+  void operator () (hb_position_t &x, hb_position_t &y) const
+  {
+    float fx = x, fy = y;
+    x = roundf (xx * fx + xy * fy + dx);
+    y = roundf (yx * fx + yy * fy + dy);
+  }
+
+  float xx, yx, xy, yy, dx, dy;
+};
+
+template <typename transform_t>
+void
+hb_glyph_path_t::draw (const hb_draw_funcs_t *funcs, void *user_data,
+		       const transform_t &transform) const
+{
+  /* Ops were cleaned up by draw_helper_t when recorded, so they go
+   * straight to the callbacks; only quadratics may need converting, the
+   * same way draw_helper_t does it. */
+  const hb_position_t *p = points.arrayZ;
+  const hb_position_t *end = p + points.length;
+  hb_position_t current_x = 0, current_y = 0;
+  hb_position_t v[6];
+  for (uint8_t verb : verbs)
+  {
+    unsigned count;
+    switch (verb)
+    {
+    case HB_GLYPH_PATH_VERB_MOVE_TO:
+    case HB_GLYPH_PATH_VERB_LINE_TO:	 count = 2; break;
+    case HB_GLYPH_PATH_VERB_QUADRATIC_TO: count = 4; break;
+    case HB_GLYPH_PATH_VERB_CUBIC_TO:	 count = 6; break;
+    default:				 count = 0; break;
+    }
+    if (unlikely (end - p < (int) count)) return;
+    for (unsigned i = 0; i < count; i += 2)
+    {
+      v[i] = p[i];
+      v[i + 1] = p[i + 1];
+      transform (v[i], v[i + 1]);
+    }
+    p += count;
+
+    switch (verb)
+    {
+    case HB_GLYPH_PATH_VERB_MOVE_TO:
+      funcs->move_to (v[0], v[1], user_data);
+      break;
+    case HB_GLYPH_PATH_VERB_LINE_TO:
+      funcs->line_to (v[0], v[1], user_data);
+      break;
+    case HB_GLYPH_PATH_VERB_QUADRATIC_TO:
+      if (funcs->is_quadratic_to_set)
+	funcs->quadratic_to (v[0], v[1], v[2], v[3], user_data);
+      else
+	funcs->cubic_to (roundf ((current_x + 2.f * v[0]) / 3.f),
+			 roundf ((current_y + 2.f * v[1]) / 3.f),
+			 roundf ((v[2] + 2.f * v[0]) / 3.f),
+			 roundf ((v[3] + 2.f * v[1]) / 3.f),
+			 v[2], v[3], user_data);
+      break;
+    case HB_GLYPH_PATH_VERB_CUBIC_TO:
+      funcs->cubic_to (v[0], v[1], v[2], v[3], v[4], v[5], user_data);
+      break;
+    case HB_GLYPH_PATH_VERB_CLOSE_PATH:
+      funcs->close_path (user_data);
+      break;
+    default:
+      break;
+    }
+    if (count)
+    {
+      current_x = v[count - 2];
+      current_y = v[count - 1];
+    }
+  }
+}
+
+/**
+ * hb_glyph_path_get_empty:
+ *
+ * Fetches the singleton empty glyph path object.
+ *
+ * Return value: (transfer full): The empty glyph path object
+ *
+ * Since: EXPERIMENTAL
+ **/
+hb_glyph_path_t *
+hb_glyph_path_get_empty ()
+{
+  return const_cast<hb_glyph_path_t *> (&Null (hb_glyph_path_t));
+}
+
+/**
+ * hb_glyph_path_reference: (skip)
+ * @path: a glyph path object
+ *
+ * Increases the reference count on @path by one.
+ *
+ * Return value: (transfer full): The same object.
+ *
+ * Since: EXPERIMENTAL
+ **/
+hb_glyph_path_t *
+hb_glyph_path_reference (hb_glyph_path_t *path)
+{
+  return hb_object_reference (path);
+}
+
+/**
+ * hb_glyph_path_destroy: (skip)
+ * @path: a glyph path object
+ *
+ * Decreases the reference count on @path by one.  When the reference
+ * count reaches zero, the path is destroyed, freeing all memory.
+ *
+ * Since: EXPERIMENTAL
+ **/
+void
+hb_glyph_path_destroy (hb_glyph_path_t *path)
+{
+  if (!hb_object_destroy (path)) return;
+
+  path->fini ();
+  hb_free (path);
+}
+
+/**
+ * hb_glyph_path_set_user_data: (skip)
+ * @path: a glyph path object
+ * @key: The user-data key to set
+ * @data: A pointer to the user data
+ * @destroy: (nullable): A callback to call when @data is not needed anymore
+ * @replace: Whether to replace an existing data with the same key
+ *
+ * Attaches a user-data key/data pair to the specified glyph path.
+ *
+ * Return value: %true if success, %false otherwise
+ *
+ * Since: EXPERIMENTAL
+ **/
+hb_bool_t
+hb_glyph_path_set_user_data (hb_glyph_path_t    *path,
+			     hb_user_data_key_t *key,
+			     void *              data,
+			     hb_destroy_func_t   destroy,
+			     hb_bool_t           replace)
+{
+  return hb_object_set_user_data (path, key, data, destroy, replace);
+}
+
+/**
+ * hb_glyph_path_get_user_data: (skip)
+ * @path: a glyph path object
+ * @key: The user-data key to query
+ *
+ * Fetches the user data associated with the specified key,
+ * attached to the specified glyph path.
+ *
+ * Return value: (transfer none): A pointer to the user data
+ *
+ * Since: EXPERIMENTAL
+ **/
+void *
+hb_glyph_path_get_user_data (hb_glyph_path_t    *path,
+			     hb_user_data_key_t *key)
+{
+  return hb_object_get_user_data (path, key);
+}
+
+/**
+ * hb_glyph_path_get_verbs:
+ * @path: a glyph path object
+ * @length: (out) (optional): Number of verbs
+ *
+ * Fetches the drawing operations of @path, as #hb_glyph_path_verb_t
+ * values.
+ *
+ * Return value: (transfer none) (array length=length): The verbs
+ *
+ * Since: EXPERIMENTAL
+ **/
+const uint8_t *
+hb_glyph_path_get_verbs (hb_glyph_path_t *path,
+			 unsigned int    *length)
+{
+  if (length) *length = path->verbs.length;
+  return path->verbs.arrayZ;
+}
+
+/**
+ * hb_glyph_path_get_points:
+ * @path: a glyph path object
+ * @length: (out) (optional): Number of points
+ *
+ * Fetches the points of @path, as consecutive x,y pairs, in the order
+ * the verbs of @path consume them.
+ *
+ * Return value: (transfer none): The points; twice @length values
+ *
+ * Since: EXPERIMENTAL
+ **/
+const hb_position_t *
+hb_glyph_path_get_points (hb_glyph_path_t *path,
+			  unsigned int    *length)
+{
+  if (length) *length = path->points.length / 2;
+  return path->points.arrayZ;
+}
+
+/**
+ * hb_glyph_path_draw:
+ * @path: a glyph path object
+ * @funcs: draw callbacks object
+ * @user_data: parameter you like be passed to the callbacks when are called
+ *
+ * Draws @path, calling @funcs the same way hb_font_draw_glyph() would
+ * for the glyph it was fetched for.
+ *
+ * Since: EXPERIMENTAL
+ **/
+void
+hb_glyph_path_draw (hb_glyph_path_t       *path,
+		    const hb_draw_funcs_t *funcs,
+		    void                  *user_data)
+{
+  if (unlikely (funcs == &Null (hb_draw_funcs_t))) return;
+  path->draw (funcs, user_data, hb_glyph_path_identity_t ());
+}
+
+/**
+ * hb_glyph_path_draw_transformed:
+ * @path: a glyph path object
+ * @funcs: draw callbacks object
+ * @user_data: parameter you like be passed to the callbacks when are called
+ * @xx: xx component of the transformation
+ * @yx: yx component of the transformation
+ * @xy: xy component of the transformation
+ * @yy: yy component of the transformation
+ * @dx: x translation of the transformation
+ * @dy: y translation of the transformation
+ *
+ * Draws @path like hb_glyph_path_draw(), mapping each point (x, y) to
+ * (xx * x + xy * y + dx, yx * x + yy * y + dy), rounded.
+ *
+ * Since: EXPERIMENTAL
+ **/
+void
+hb_glyph_path_draw_transformed (hb_glyph_path_t       *path,
+				const hb_draw_funcs_t *funcs,
+				void                  *user_data,
+				float                  xx,
+				float                  yx,
+				float                  xy,
+				float                  yy,
+				float                  dx,
+				float                  dy)
+{
+  if (unlikely (funcs == &Null (hb_draw_funcs_t))) return;
+  hb_glyph_path_affine_t transform = {xx, yx, xy, yy, dx, dy};
+  path->draw (funcs, user_data, transform);
+}
+
+
+/*
+ * hb_glyph_path_cache_t
+ */
+
+void
+hb_glyph_path_cache_t::init ()
+{
+  lock.init ();
+  serial = 0;
+  tick = 0;
+  slots.init ();
+  entries.init ();
+  stats.init ();
+}
+
+void
+hb_glyph_path_cache_t::fini ()
+{
+  stats.report (this, "glyph path cache");
+  clear ();
+  stats.fini ();
+  entries.fini ();
+  slots.fini ();
+  lock.fini ();
+}
+
+void
+hb_glyph_path_cache_t::clear ()
+{
+  for (const entry_t &entry : entries)
+    hb_glyph_path_destroy (entry.path);
+  entries.resize (0);
+  slots.clear ();
+}
+
+hb_glyph_path_t *
+hb_glyph_path_cache_t::get (hb_font_t *font, hb_codepoint_t glyph)
+{
+  hb_lock_t l (lock);
+  if (serial != font->serial)
+  {
+    clear ();
+    serial = font->serial;
+  }
+  unsigned i = slots.get (glyph);
+  if (i == HB_MAP_VALUE_INVALID)
+  {
+    stats.miss ();
+    return nullptr;
+  }
+  stats.hit ();
+  entries[i].last_used = ++tick;
+  return hb_glyph_path_reference (entries[i].path);
+}
+
+void
+hb_glyph_path_cache_t::set (hb_font_t *font, hb_codepoint_t glyph, hb_glyph_path_t *path)
+{
+  hb_lock_t l (lock);
+  if (serial != font->serial || slots.has (glyph))
+    return;
+
+  unsigned i = entries.length;
+  if (i < MAX_PATHS)
+  {
+    if (unlikely (!entries.resize (i + 1))) return;
+  }
+  else
+  {
+    /* Evict the least recently used. */
+    i = 0;
+    for (unsigned j = 1; j < entries.length; j++)
+      if (tick - entries[j].last_used > tick - entries[i].last_used)
+	i = j;
+    slots.del (entries[i].glyph);
+    hb_glyph_path_destroy (entries[i].path);
+    entries[i].path = nullptr;
+  }
+
+  slots.set (glyph, i);
+  if (unlikely (slots.in_error ()))
+  {
+    clear ();
+    slots.reset ();
+    return;
+  }
+  entry_t &entry = entries[i];
+  entry.glyph = glyph;
+  entry.last_used = ++tick;
+  entry.path = hb_glyph_path_reference (path);
+}
+
+void
+hb_glyph_path_cache_destroy (hb_glyph_path_cache_t *cache)
+{
+  if (!cache) return;
+  cache->fini ();
+  hb_free (cache);
+}
+
+static hb_glyph_path_cache_t *
+_hb_font_get_glyph_path_cache (hb_font_t *font)
+{
+retry:
+  hb_glyph_path_cache_t *cache = font->glyph_path_cache.get ();
+  if (likely (cache) || unlikely (hb_object_is_inert (font)))
+    return cache;
+
+  cache = (hb_glyph_path_cache_t *) hb_calloc (1, sizeof (hb_glyph_path_cache_t));
+  if (unlikely (!cache))
+    return nullptr;
+  cache->init ();
+  if (unlikely (!font->glyph_path_cache.cmpexch (nullptr, cache)))
+  {
+    hb_glyph_path_cache_destroy (cache);
+    goto retry;
+  }
+  return cache;
+}
+
+/**
+ * hb_font_get_glyph_path:
+ * @font: a font object
+ * @glyph: a glyph id
+ *
+ * Fetches the outline of @glyph, as hb_font_draw_glyph() would draw it,
+ * to be drawn any number of times with hb_glyph_path_draw() without
+ * decoding the glyph again.  The most recently used paths are cached on
+ * @font until it is changed, so fetching the same glyph again is cheap.
+ *
+ * The path is in font scale and does not change if @font does later.
+ *
+ * Return value: (transfer full): The glyph path, or the empty path if
+ * the font has no outline for @glyph.  Destroy with
+ * hb_glyph_path_destroy().
+ *
+ * Since: EXPERIMENTAL
+ **/
+hb_glyph_path_t *
+hb_font_get_glyph_path (hb_font_t *font, hb_codepoint_t glyph)
+{
+  hb_glyph_path_cache_t *cache = _hb_font_get_glyph_path_cache (font);
+  hb_glyph_path_t *path = cache ? cache->get (font, glyph) : nullptr;
+  if (path) return path;
+
+  path = hb_object_create<hb_glyph_path_t> ();
+  if (unlikely (!path))
+    return hb_glyph_path_get_empty ();
+
+  if (unlikely (!hb_font_draw_glyph (font, glyph, &_hb_glyph_path_recorder, path) ||
+		path->verbs.in_error () || path->points.in_error ()))
+  {
+    hb_glyph_path_destroy (path);
+    return hb_glyph_path_get_empty ();
+  }
+
+  if (cache) cache->set (font, glyph, path);
+  return path;
+}
+
 #endif
 #endif
@@ -91,6 +91,84 @@ hb_draw_funcs_make_immutable (hb_draw_funcs_t *funcs);
 
 HB_EXTERN hb_bool_t
 hb_draw_funcs_is_immutable (hb_draw_funcs_t *funcs);
+
+/**
+ * hb_glyph_path_verb_t:
+ * @HB_GLYPH_PATH_VERB_MOVE_TO: Takes one point.
+ * @HB_GLYPH_PATH_VERB_LINE_TO: Takes one point.
+ * @HB_GLYPH_PATH_VERB_QUADRATIC_TO: Takes two points, the control point
+ * and the end point.
+ * @HB_GLYPH_PATH_VERB_CUBIC_TO: Takes three points, the two control
+ * points and the end point.
+ * @HB_GLYPH_PATH_VERB_CLOSE_PATH: Takes no point.
+ *
+ * The drawing operations stored in a #hb_glyph_path_t, matching the
+ * callbacks of #hb_draw_funcs_t.
+ *
+ * Since: EXPERIMENTAL
+ **/
+typedef enum {
+  HB_GLYPH_PATH_VERB_MOVE_TO,
+  HB_GLYPH_PATH_VERB_LINE_TO,
+  HB_GLYPH_PATH_VERB_QUADRATIC_TO,
+  HB_GLYPH_PATH_VERB_CUBIC_TO,
+  HB_GLYPH_PATH_VERB_CLOSE_PATH
+} hb_glyph_path_verb_t;
+
+/**
+ * hb_glyph_path_t:
+ *
+ * Data type holding the outline of a glyph, as drawn by
+ * hb_font_draw_glyph(), for drawing it again without decoding the
+ * glyph.  Immutable.
+ *
+ * Since: EXPERIMENTAL
+ **/
+typedef struct hb_glyph_path_t hb_glyph_path_t;
+
+HB_EXTERN hb_glyph_path_t *
+hb_glyph_path_get_empty (void);
+
+HB_EXTERN hb_glyph_path_t *
+hb_glyph_path_reference (hb_glyph_path_t *path);
+
+HB_EXTERN void
+hb_glyph_path_destroy (hb_glyph_path_t *path);
+
+HB_EXTERN hb_bool_t
+hb_glyph_path_set_user_data (hb_glyph_path_t    *path,
+			     hb_user_data_key_t *key,
+			     void *              data,
+			     hb_destroy_func_t   destroy,
+			     hb_bool_t           replace);
+
+HB_EXTERN void *
+hb_glyph_path_get_user_data (hb_glyph_path_t    *path,
+			     hb_user_data_key_t *key);
+
+HB_EXTERN const uint8_t *
+hb_glyph_path_get_verbs (hb_glyph_path_t *path,
+			 unsigned int    *length);
+
+HB_EXTERN const hb_position_t *
+hb_glyph_path_get_points (hb_glyph_path_t *path,
+			  unsigned int    *length);
+
+HB_EXTERN void
+hb_glyph_path_draw (hb_glyph_path_t       *path,
+		    const hb_draw_funcs_t *funcs,
+		    void                  *user_data);
+
+HB_EXTERN void
+hb_glyph_path_draw_transformed (hb_glyph_path_t       *path,
+				const hb_draw_funcs_t *funcs,
+				void                  *user_data,
+				float                  xx,
+				float                  yx,
+				float                  xy,
+				float                  yy,
+				float                  dx,
+				float                  dy);
 #endif
 
 HB_END_DECLS
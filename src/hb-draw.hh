@@ -26,6 +26,8 @@
 #define HB_DRAW_HH
 
 #include "hb.hh"
+#include "hb-cache.hh"
+#include "hb-map.hh"
 
 #ifdef HB_EXPERIMENTAL_API
 struct hb_draw_funcs_t
@@ -134,6 +136,64 @@ struct draw_helper_t
   const hb_draw_funcs_t *funcs;
   void *user_data;
 };
+
+/* A glyph outline as it was drawn, after draw_helper_t cleaned it up, so
+ * already in font scale with closed contours.  Quadratic curves are kept
+ * as such and only turned into cubics at replay time if the receiving
+ * funcs want that. */
+struct hb_glyph_path_t
+{
+  hb_object_header_t header;
+
+  hb_vector_t<uint8_t> verbs; /* hb_glyph_path_verb_t. */
+  hb_vector_t<hb_position_t> points; /* x,y pairs. */
+
+  void fini ()
+  {
+    verbs.fini ();
+    points.fini ();
+  }
+
+  template <typename transform_t>
+  void draw (const hb_draw_funcs_t *funcs, void *user_data, const transform_t &transform) const;
+};
+
+/* Least-recently-used cache of glyph paths, owned by the font.  Bounded
+ * by number of paths; a path handed out stays alive on its own after it
+ * is evicted since the cache only holds one reference.  Dropped wholesale
+ * the first time it is used after the font changes, keyed off
+ * hb_font_t::serial. */
+struct hb_glyph_path_cache_t
+{
+  static constexpr unsigned MAX_PATHS = 256;
+
+  void init ();
+  void fini ();
+
+  /* Returns a new reference, or nullptr. */
+  hb_glyph_path_t *get (hb_font_t *font, hb_codepoint_t glyph);
+  void set (hb_font_t *font, hb_codepoint_t glyph, hb_glyph_path_t *path);
+
+  private:
+  void clear ();
+
+  struct entry_t
+  {
+    hb_codepoint_t glyph;
+    unsigned int last_used;
+    hb_glyph_path_t *path;
+  };
+
+  hb_mutex_t lock;
+  unsigned int serial;
+  unsigned int tick;
+  hb_map_t slots; /* glyph -> index into entries. */
+  hb_vector_t<entry_t> entries;
+  hb_cache_stats_t stats;
+};
+
+HB_INTERNAL void
+hb_glyph_path_cache_destroy (hb_glyph_path_cache_t *cache);
 #endif
 
 #endif /* HB_DRAW_HH */
@@ -136,6 +136,8 @@ hb_face_create_for_tables (hb_reference_table_func_t  reference_table_func,
   face->data.init0 (face);
   face->table.init0 (face);
 
+  face->shape_plans.init ();
+
   return face;
 }
 
@@ -277,13 +279,7 @@ hb_face_destroy (hb_face_t *face)
 {
   if (!hb_object_destroy (face)) return;
 
-  for (hb_face_t::plan_node_t *node = face->shape_plans; node; )
-  {
-    hb_face_t::plan_node_t *next = node->next;
-    hb_shape_plan_destroy (node->shape_plan);
-    hb_free (node);
-    node = next;
-  }
+  face->shape_plans.fini ();
 
   face->data.fini ();
   face->table.fini ();
@@ -764,3 +760,19 @@ hb_face_builder_add_table (hb_face_t *face, hb_tag_t tag, hb_blob_t *blob)
 
   return true;
 }
+
+/* Adds the tables of builder face @other to builder face @face, in the
+ * order they were added to @other. */
+bool
+hb_face_builder_add_tables_from (hb_face_t *face, hb_face_t *other)
+{
+  if (unlikely (other->destroy != (hb_destroy_func_t) _hb_face_builder_data_destroy))
+    return false;
+
+  const hb_face_builder_data_t *data = (const hb_face_builder_data_t *) other->user_data;
+  for (unsigned int i = 0; i < data->tables.length; i++)
+    if (unlikely (!hb_face_builder_add_table (face, data->tables[i].tag, data->tables[i].blob)))
+      return false;
+
+  return true;
+}
@@ -60,12 +60,7 @@ struct hb_face_t
   hb_ot_face_t table;			/* All the face's tables. */
 
   /* Cache */
-  struct plan_node_t
-  {
-    hb_shape_plan_t *shape_plan;
-    plan_node_t *next;
-  };
-  hb_atomic_ptr_t<plan_node_t> shape_plans;
+  hb_shape_plan_cache_t shape_plans;
 
   hb_blob_t *reference_table (hb_tag_t tag) const
   {
@@ -105,5 +100,8 @@ struct hb_face_t
 };
 DECLARE_NULL_INSTANCE (hb_face_t);
 
+HB_INTERNAL bool
+hb_face_builder_add_tables_from (hb_face_t *face, hb_face_t *other);
+
 
 #endif /* HB_FACE_HH */
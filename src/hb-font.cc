@@ -29,6 +29,7 @@
 #include "hb.hh"
 
 #include "hb-font.hh"
+#include "hb-draw.hh"
 #include "hb-machinery.hh"
 
 #include "hb-ot.h"
@@ -1471,6 +1472,7 @@ hb_font_glyph_from_string (hb_font_t      *font,
 DEFINE_NULL_INSTANCE (hb_font_t) =
 {
   HB_OBJECT_HEADER_STATIC,
+  0, /* serial */
 
   nullptr, /* parent */
   const_cast<hb_face_t *> (&_hb_Null_hb_face_t),
@@ -1487,6 +1489,8 @@ DEFINE_NULL_INSTANCE (hb_font_t) =
   0, /* num_coords */
   nullptr, /* coords */
   nullptr, /* design_coords */
+  0, /* serial_coords */
+  {}, /* var_scalars */
 
   const_cast<hb_font_funcs_t *> (&_hb_Null_hb_font_funcs_t),
 
@@ -1509,6 +1513,7 @@ _hb_font_create (hb_face_t *face)
   font->face = hb_face_reference (face);
   font->klass = hb_font_funcs_get_empty ();
   font->data.init0 (font);
+  font->var_scalars.init ();
   font->x_scale = font->y_scale = hb_face_get_upem (face);
   font->x_mult = font->y_mult = 1 << 16;
 
@@ -1550,6 +1555,9 @@ _hb_font_adopt_var_coords (hb_font_t *font,
   font->coords = coords;
   font->design_coords = design_coords;
   font->num_coords = coords_length;
+  font->serial++;
+  font->serial_coords++;
+  font->var_scalars.clear ();
 }
 
 /**
@@ -1652,6 +1660,10 @@ hb_font_destroy (hb_font_t *font)
 
   font->data.fini ();
 
+#if defined(HB_EXPERIMENTAL_API) && !defined(HB_NO_DRAW)
+  hb_glyph_path_cache_destroy (font->glyph_path_cache.get ());
+#endif
+
   if (font->destroy)
     font->destroy (font->user_data);
 
@@ -1661,6 +1673,7 @@ hb_font_destroy (hb_font_t *font)
 
   hb_free (font->coords);
   hb_free (font->design_coords);
+  font->var_scalars.fini ();
 
   hb_free (font);
 }
@@ -1760,6 +1773,8 @@ hb_font_set_parent (hb_font_t *font,
   if (hb_object_is_immutable (font))
     return;
 
+  font->serial++;
+
   if (!parent)
     parent = hb_font_get_empty ();
 
@@ -1802,6 +1817,10 @@ hb_font_set_face (hb_font_t *font,
   if (hb_object_is_immutable (font))
     return;
 
+  font->serial++;
+  /* The coords now apply to another face's variation data. */
+  font->serial_coords++;
+
   if (unlikely (!face))
     face = hb_face_get_empty ();
 
@@ -1810,6 +1829,8 @@ hb_font_set_face (hb_font_t *font,
   hb_face_make_immutable (face);
   font->face = hb_face_reference (face);
   font->mults_changed ();
+  /* Keyed by addresses into the old face's tables. */
+  font->var_scalars.clear ();
 
   hb_face_destroy (old);
 }
@@ -1856,6 +1877,8 @@ hb_font_set_funcs (hb_font_t         *font,
     return;
   }
 
+  font->serial++;
+
   if (font->destroy)
     font->destroy (font->user_data);
 
@@ -1893,6 +1916,8 @@ hb_font_set_funcs_data (hb_font_t         *font,
     return;
   }
 
+  font->serial++;
+
   if (font->destroy)
     font->destroy (font->user_data);
 
@@ -1919,6 +1944,8 @@ hb_font_set_scale (hb_font_t *font,
   if (hb_object_is_immutable (font))
     return;
 
+  font->serial++;
+
   font->x_scale = x_scale;
   font->y_scale = y_scale;
   font->mults_changed ();
@@ -1961,6 +1988,8 @@ hb_font_set_ppem (hb_font_t    *font,
   if (hb_object_is_immutable (font))
     return;
 
+  font->serial++;
+
   font->x_ppem = x_ppem;
   font->y_ppem = y_ppem;
 }
@@ -2003,6 +2032,8 @@ hb_font_set_ptem (hb_font_t *font,
   if (hb_object_is_immutable (font))
     return;
 
+  font->serial++;
+
   font->ptem = ptem;
 }
 
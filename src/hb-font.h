@@ -1056,6 +1056,9 @@ hb_font_set_var_named_instance (hb_font_t *font,
 HB_EXTERN hb_bool_t
 hb_font_draw_glyph (hb_font_t *font, hb_codepoint_t glyph,
 		    const hb_draw_funcs_t *funcs, void *user_data);
+
+HB_EXTERN hb_glyph_path_t *
+hb_font_get_glyph_path (hb_font_t *font, hb_codepoint_t glyph);
 #endif
 
 HB_END_DECLS
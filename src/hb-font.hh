@@ -92,6 +92,81 @@ struct hb_font_funcs_t
 DECLARE_NULL_INSTANCE (hb_font_funcs_t);
 
 
+/*
+ * hb_font_var_scalars_t
+ */
+
+/* Scalars of variation regions at the font's coordinates, one array per
+ * table that asks for them (gvar shared tuples, the region list of each
+ * variation store), keyed by the address of what they were computed
+ * from.  Filled lazily and lockfree; flushed when the coordinates or
+ * the face change, which may only happen while the font is not in use. */
+struct hb_font_var_scalars_t
+{
+  static constexpr unsigned MAX_ENTRIES = 8;
+
+  struct entry_t
+  {
+    const void *key;
+    unsigned count;
+
+    float *scalars () { return reinterpret_cast<float *> (this + 1); }
+  };
+
+  void init ()
+  {
+    for (unsigned i = 0; i < ARRAY_LENGTH (entries); i++)
+      entries[i].init ();
+  }
+  void fini () { clear (); }
+
+  void clear ()
+  {
+    for (unsigned i = 0; i < ARRAY_LENGTH (entries); i++)
+    {
+      hb_free (entries[i].get_relaxed ());
+      entries[i].set_relaxed (nullptr);
+    }
+  }
+
+  /* Returns the count scalars for key, calling compute (i) for each
+   * the first time; an empty array if out of room or memory. */
+  template <typename Compute>
+  hb_array_t<const float> get (const void *key, unsigned count, Compute compute)
+  {
+    for (unsigned i = 0; i < ARRAY_LENGTH (entries); i++)
+    {
+    retry:
+      entry_t *e = entries[i].get ();
+      if (e)
+      {
+	if (e->key == key)
+	  return hb_array (e->scalars (), e->count);
+	continue;
+      }
+
+      e = (entry_t *) hb_malloc (sizeof (entry_t) + count * sizeof (float));
+      if (unlikely (!e))
+	return hb_array_t<const float> ();
+      e->key = key;
+      e->count = count;
+      for (unsigned j = 0; j < count; j++)
+	e->scalars ()[j] = compute (j);
+      if (unlikely (!entries[i].cmpexch (nullptr, e)))
+      {
+	hb_free (e);
+	goto retry;
+      }
+      return hb_array (e->scalars (), e->count);
+    }
+    return hb_array_t<const float> ();
+  }
+
+  private:
+  hb_atomic_ptr_t<entry_t> entries[MAX_ENTRIES];
+};
+
+
 /*
  * hb_font_t
  */
@@ -100,9 +175,12 @@ DECLARE_NULL_INSTANCE (hb_font_funcs_t);
 #include "hb-shaper-list.hh"
 #undef HB_SHAPER_IMPLEMENT
 
+struct hb_glyph_path_cache_t;
+
 struct hb_font_t
 {
   hb_object_header_t header;
+  unsigned int serial; /* Bumped every time the font changes. */
 
   hb_font_t *parent;
   hb_face_t *face;
@@ -121,6 +199,8 @@ struct hb_font_t
   unsigned int num_coords;
   int *coords;
   float *design_coords;
+  unsigned int serial_coords; /* Bumped every time coords or face change. */
+  hb_font_var_scalars_t var_scalars;
 
   hb_font_funcs_t   *klass;
   void              *user_data;
@@ -128,6 +208,8 @@ struct hb_font_t
 
   hb_shaper_object_dataset_t<hb_font_t> data; /* Various shaper data. */
 
+  hb_atomic_ptr_t<hb_glyph_path_cache_t> glyph_path_cache; /* Lazily allocated; see hb-draw.hh. */
+
 
   /* Convert from font-space to user-space */
   int64_t dir_mult (hb_direction_t direction)
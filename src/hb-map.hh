@@ -56,26 +56,24 @@ struct hb_hashmap_t
 
     bool operator == (const K &o) { return hb_deref (key) == hb_deref (o); }
     bool operator == (const item_t &o) { return *this == o.key; }
-    bool is_unused () const    { return key == kINVALID; }
-    bool is_tombstone () const { return key != kINVALID && value == vINVALID; }
-    bool is_real () const { return key != kINVALID && value != vINVALID; }
+    bool is_unused () const { return key == kINVALID; }
+    bool is_real () const { return key != kINVALID; }
     hb_pair_t<K, V> get_pair() const { return hb_pair_t<K, V> (key, value); }
   };
 
   hb_object_header_t header;
   bool successful; /* Allocations successful */
-  unsigned int population; /* Not including tombstones. */
-  unsigned int occupancy; /* Including tombstones. */
+  unsigned int population;
   unsigned int mask;
-  unsigned int prime;
+  unsigned int shift; /* 32 - log2 (mask + 1) */
   item_t *items;
 
   void init_shallow ()
   {
     successful = true;
-    population = occupancy = 0;
+    population = 0;
     mask = 0;
-    prime = 0;
+    shift = 32;
     items = nullptr;
   }
   void init ()
@@ -87,7 +85,7 @@ struct hb_hashmap_t
   {
     hb_free (items);
     items = nullptr;
-    population = occupancy = 0;
+    population = 0;
   }
   void fini ()
   {
@@ -122,18 +120,16 @@ struct hb_hashmap_t
     item_t *old_items = items;
 
     /* Switch to new, empty, array. */
-    population = occupancy = 0;
+    population = 0;
     mask = new_size - 1;
-    prime = prime_for (power);
+    shift = 32 - power;
     items = new_items;
 
     /* Insert back old items. */
     if (old_items)
       for (unsigned int i = 0; i < old_size; i++)
 	if (old_items[i].is_real ())
-	  set_with_hash (old_items[i].key,
-			 old_items[i].hash,
-			 old_items[i].value);
+	  insert_new (old_items[i]);
 
     hb_free (old_items);
 
@@ -148,8 +144,8 @@ struct hb_hashmap_t
   V get (K key) const
   {
     if (unlikely (!items)) return vINVALID;
-    unsigned int i = bucket_for (key);
-    return items[i].is_real () && items[i] == key ? items[i].value : vINVALID;
+    unsigned int i;
+    return find (key, hb_hash (key), &i) ? items[i].value : vINVALID;
   }
 
   void del (K key) { set (key, vINVALID); }
@@ -173,7 +169,7 @@ struct hb_hashmap_t
       for (auto &_ : hb_iter (items, mask + 1))
 	_.clear ();
 
-    population = occupancy = 0;
+    population = 0;
   }
 
   bool is_empty () const { return population == 0; }
@@ -211,104 +207,102 @@ struct hb_hashmap_t
 
   protected:
 
+  /* Robin Hood hashing with linear probing: an item sits at most as far
+   * from its home bucket as the items it was placed after, so lookups can
+   * stop at the first item closer to home than the probe, and deletion
+   * shifts the following items back instead of leaving tombstones. */
+
   bool set_with_hash (K key, uint32_t hash, V value)
   {
     if (unlikely (!successful)) return false;
     if (unlikely (key == kINVALID)) return true;
-    if (unlikely ((occupancy + occupancy / 2) >= mask && !resize ())) return false;
-    unsigned int i = bucket_for_hash (key, hash);
-
-    if (value == vINVALID && items[i].key != key)
-      return true; /* Trying to delete non-existent key. */
 
-    if (!items[i].is_unused ())
+    unsigned int i;
+    if (items && find (key, hash, &i))
     {
-      occupancy--;
-      if (items[i].is_tombstone ())
-	population--;
+      if (value == vINVALID)
+	erase (i);
+      else
+	items[i].value = value;
+      return true;
     }
 
-    items[i].key = key;
-    items[i].value = value;
-    items[i].hash = hash;
+    if (value == vINVALID)
+      return true; /* Trying to delete non-existent key. */
+
+    if (unlikely ((population + population / 2) >= mask && !resize ())) return false;
 
-    occupancy++;
-    if (!items[i].is_tombstone ())
-      population++;
+    item_t item;
+    item.key = key;
+    item.value = value;
+    item.hash = hash;
+    insert_new (item);
 
     return true;
   }
 
-  unsigned int bucket_for (K key) const
+  unsigned int bucket_for_hash (uint32_t hash) const
+  {
+    /* hb_hash() of integers is already a multiplicative hash, whose top
+     * bits are the well-mixed ones. */
+    return shift < 32 ? hash >> shift : 0;
+  }
+
+  unsigned int distance (unsigned int i) const
+  { return (i - bucket_for_hash (items[i].hash)) & mask; }
+
+  bool find (K key, uint32_t hash, unsigned int *pos) const
   {
-    return bucket_for_hash (key, hb_hash (key));
+    unsigned int i = bucket_for_hash (hash);
+    for (unsigned int dist = 0; ; dist++)
+    {
+      const item_t &item = items[i];
+      if (item.is_unused () || distance (i) < dist)
+	return false;
+      if (item.hash == hash && items[i] == key)
+      {
+	*pos = i;
+	return true;
+      }
+      i = (i + 1) & mask;
+    }
   }
 
-  unsigned int bucket_for_hash (K key, uint32_t hash) const
+  /* Key must not be in the map yet, and there must be room for it. */
+  void insert_new (item_t item)
   {
-    unsigned int i = hash % prime;
-    unsigned int step = 0;
-    unsigned int tombstone = (unsigned) -1;
-    while (!items[i].is_unused ())
+    unsigned int i = bucket_for_hash (item.hash);
+    for (unsigned int dist = 0; ; dist++)
     {
-      if (items[i].hash == hash && items[i] == key)
-	return i;
-      if (tombstone == (unsigned) -1 && items[i].is_tombstone ())
-	tombstone = i;
-      i = (i + ++step) & mask;
+      if (items[i].is_unused ())
+      {
+	items[i] = item;
+	population++;
+	return;
+      }
+      unsigned int d = distance (i);
+      if (d < dist)
+      {
+	item_t t = items[i];
+	items[i] = item;
+	item = t;
+	dist = d;
+      }
+      i = (i + 1) & mask;
     }
-    return tombstone == (unsigned) -1 ? i : tombstone;
   }
 
-  static unsigned int prime_for (unsigned int shift)
+  void erase (unsigned int i)
   {
-    /* Following comment and table copied from glib. */
-    /* Each table size has an associated prime modulo (the first prime
-     * lower than the table size) used to find the initial bucket. Probing
-     * then works modulo 2^n. The prime modulo is necessary to get a
-     * good distribution with poor hash functions.
-     */
-    /* Not declaring static to make all kinds of compilers happy... */
-    /*static*/ const unsigned int prime_mod [32] =
+    unsigned int j = (i + 1) & mask;
+    while (items[j].is_real () && distance (j) > 0)
     {
-      1,          /* For 1 << 0 */
-      2,
-      3,
-      7,
-      13,
-      31,
-      61,
-      127,
-      251,
-      509,
-      1021,
-      2039,
-      4093,
-      8191,
-      16381,
-      32749,
-      65521,      /* For 1 << 16 */
-      131071,
-      262139,
-      524287,
-      1048573,
-      2097143,
-      4194301,
-      8388593,
-      16777213,
-      33554393,
-      67108859,
-      134217689,
-      268435399,
-      536870909,
-      1073741789,
-      2147483647  /* For 1 << 31 */
-    };
-
-    if (unlikely (shift >= ARRAY_LENGTH (prime_mod)))
-      return prime_mod[ARRAY_LENGTH (prime_mod) - 1];
-
-    return prime_mod[shift];
+      items[i] = items[j];
+      i = j;
+      j = (j + 1) & mask;
+    }
+    items[i].clear ();
+    population--;
   }
 };
 
@@ -286,25 +286,19 @@ struct CFFIndex
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
+    /* Only the data up to the last offset is checked; the offsets of each
+     * object are checked against it by length_at() when it is accessed.
+     * Saves walking all the offsets of CharStrings up front.
+     *
+     * A 32-bit count of 0xFFFFFFFF has no last offset we can index:
+     * count + 1 wraps to zero. */
     return_trace (likely ((c->check_struct (this) && count == 0) || /* empty INDEX */
 			  (c->check_struct (this) && offSize >= 1 && offSize <= 4 &&
-			   c->check_array (offsets, offSize, count + 1) &&
-			   c->check_array ((const HBUINT8*) data_base (), 1, max_offset () - 1))));
+			   count + 1u != 0 &&
+			   c->check_array (offsets, offSize, count + 1u) &&
+			   c->check_array ((const HBUINT8*) data_base (), 1, offset_at (count) - 1))));
   }
 
-  protected:
-  unsigned int max_offset () const
-  {
-    unsigned int max = 0;
-    for (unsigned int i = 0; i < count + 1u; i++)
-    {
-      unsigned int off = offset_at (i);
-      if (off > max) max = off;
-    }
-    return max;
-  }
-
-  public:
   COUNT		count;		/* Number of object data. Note there are (count+1) offsets */
   HBUINT8	offSize;	/* The byte size of each offset in the offsets array. */
   HBUINT8	offsets[HB_VAR_ARRAY];
@@ -471,13 +465,8 @@ struct FDSelect0 {
   bool sanitize (hb_sanitize_context_t *c, unsigned int fdcount) const
   {
     TRACE_SANITIZE (this);
-    if (unlikely (!(c->check_struct (this))))
-      return_trace (false);
-    for (unsigned int i = 0; i < c->get_num_glyphs (); i++)
-      if (unlikely (!fds[i].sanitize (c)))
-	return_trace (false);
-
-    return_trace (true);
+    return_trace (c->check_struct (this) &&
+		  c->check_array (fds, c->get_num_glyphs ()));
   }
 
   hb_codepoint_t get_fd (hb_codepoint_t glyph) const
@@ -362,6 +362,97 @@ struct cff1_path_procs_extents_t : path_procs_t<cff1_path_procs_extents_t, cff1_
   }
 };
 
+struct cff1_path_build_param_t : cs_path_builder_t
+{
+  void init (const OT::cff1::accelerator_t *_cff)
+  {
+    cs_path_builder_t::init ();
+    cff = _cff;
+  }
+
+  const OT::cff1::accelerator_t *cff;
+};
+
+struct cff1_cs_opset_path_build_t : cff1_cs_opset_t<cff1_cs_opset_path_build_t, cff1_path_build_param_t,
+						    cs_path_procs_build_t<cff1_cs_interp_env_t, cff1_path_build_param_t>>
+{
+  static void process_seac (cff1_cs_interp_env_t &env, cff1_path_build_param_t& param)
+  {
+    unsigned int n = env.argStack.get_count ();
+    point_t delta;
+    delta.x = env.argStack[n-4];
+    delta.y = env.argStack[n-3];
+    hb_codepoint_t base = param.cff->std_code_to_glyph (env.argStack[n-2].to_int ());
+    hb_codepoint_t accent = param.cff->std_code_to_glyph (env.argStack[n-1].to_int ());
+    param.seac (delta, base, accent);
+  }
+};
+
+/* Returns the path of @glyph from the cache, decoding the charstring into
+ * it first if needed.  Returns nullptr if that fails or the cache is full;
+ * the charstring is then interpreted directly. */
+static const cs_path_t *
+_get_cs_path (const OT::cff1::accelerator_t *cff, hb_codepoint_t glyph)
+{
+  const cs_path_t *path = cff->path_cache.get (glyph);
+  if (likely (path) || cff->path_cache.is_full ()) return path;
+
+  unsigned int fd = cff->fdSelect->get_fd (glyph);
+  cff1_cs_interpreter_t<cff1_cs_opset_path_build_t, cff1_path_build_param_t> interp;
+  const byte_str_t str = (*cff->charStrings)[glyph];
+  interp.env.init (str, *cff, fd);
+  cff1_path_build_param_t param;
+  param.init (cff);
+  if (likely (interp.interpret (param)))
+    path = cff->path_cache.set (glyph, cff->num_glyphs, param);
+  param.fini ();
+  return path;
+}
+
+/* Computes bounds from a cached path the way cff1_path_procs_extents_t does. */
+struct cff1_extents_replay_t
+{
+  void init ()
+  {
+    path_open = false;
+    current.init ();
+    bounds.init ();
+  }
+
+  void move_to (const point_t &p)
+  {
+    path_open = false;
+    current = p;
+  }
+
+  void line_to (const point_t &p)
+  {
+    open_path ();
+    current = p;
+    bounds.update (p);
+  }
+
+  void cubic_to (const point_t &p1, const point_t &p2, const point_t &p3)
+  {
+    open_path ();
+    bounds.update (p1);
+    bounds.update (p2);
+    current = p3;
+    bounds.update (p3);
+  }
+
+  void open_path ()
+  {
+    if (path_open) return;
+    path_open = true;
+    bounds.update (current);
+  }
+
+  bool path_open;
+  point_t current;
+  bounds_t bounds;
+};
+
 static bool _get_bounds (const OT::cff1::accelerator_t *cff, hb_codepoint_t glyph, bounds_t &bounds, bool in_seac=false);
 
 struct cff1_cs_opset_extents_t : cff1_cs_opset_t<cff1_cs_opset_extents_t, cff1_extents_param_t, cff1_path_procs_extents_t>
@@ -394,6 +485,27 @@ bool _get_bounds (const OT::cff1::accelerator_t *cff, hb_codepoint_t glyph, boun
   bounds.init ();
   if (unlikely (!cff->is_valid () || (glyph >= cff->num_glyphs))) return false;
 
+  const cs_path_t *path = _get_cs_path (cff, glyph);
+  if (likely (path))
+  {
+    cff1_extents_replay_t replay;
+    replay.init ();
+    cs_path_t::seac_t seac;
+    if (path->replay (replay, seac))
+    {
+      bounds_t base_bounds, accent_bounds;
+      if (unlikely (!(!in_seac && seac.base && seac.accent
+		      && _get_bounds (cff, seac.base, base_bounds, true)
+		      && _get_bounds (cff, seac.accent, accent_bounds, true))))
+	return false;
+      replay.bounds.merge (base_bounds);
+      accent_bounds.offset (seac.delta);
+      replay.bounds.merge (accent_bounds);
+    }
+    bounds = replay.bounds;
+    return true;
+  }
+
   unsigned int fd = cff->fdSelect->get_fd (glyph);
   cff1_cs_interpreter_t<cff1_cs_opset_extents_t, cff1_extents_param_t> interp;
   const byte_str_t str = (*cff->charStrings)[glyph];
@@ -541,6 +653,24 @@ bool _get_path (const OT::cff1::accelerator_t *cff, hb_font_t *font, hb_codepoin
 {
   if (unlikely (!cff->is_valid () || (glyph >= cff->num_glyphs))) return false;
 
+  const cs_path_t *path = _get_cs_path (cff, glyph);
+  if (likely (path))
+  {
+    cff1_path_param_t param (cff, font, draw_helper, delta);
+    cs_path_t::seac_t seac;
+    if (path->replay (param, seac))
+    {
+      /* End previous path */
+      param.end_path ();
+      if (unlikely (!(!in_seac && seac.base && seac.accent
+		      && _get_path (cff, font, seac.base, draw_helper, true)
+		      && _get_path (cff, font, seac.accent, draw_helper, true, &seac.delta))))
+	return false;
+    }
+    param.end_path ();
+    return true;
+  }
+
   unsigned int fd = cff->fdSelect->get_fd (glyph);
   cff1_cs_interpreter_t<cff1_cs_opset_path_t, cff1_path_param_t> interp;
   const byte_str_t str = (*cff->charStrings)[glyph];
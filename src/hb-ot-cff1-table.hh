@@ -28,6 +28,7 @@
 #define HB_OT_CFF1_TABLE_HH
 
 #include "hb-ot-cff-common.hh"
+#include "hb-cff-interp-cs-common.hh"
 #include "hb-subset-cff1.hh"
 #include "hb-draw.hh"
 
@@ -1273,6 +1274,8 @@ struct cff1
     void init (hb_face_t *face)
     {
       SUPER::init (face);
+      path_cache_bytes.set_relaxed (0);
+      path_cache.init (&path_cache_bytes);
 
       if (!is_valid ()) return;
       if (is_CID ()) return;
@@ -1299,6 +1302,8 @@ struct cff1
     void fini ()
     {
       glyph_names.fini ();
+      path_cache.stats.report (this, "cff1 path cache");
+      path_cache.fini ();
 
       SUPER::fini ();
     }
@@ -1352,6 +1357,10 @@ struct cff1
     HB_INTERNAL bool get_path (hb_font_t *font, hb_codepoint_t glyph, draw_helper_t &draw_helper) const;
 #endif
 
+    /* Decoded glyph outlines; see _get_cs_path(). */
+    mutable CFF::cs_path_cache_t path_cache;
+    mutable hb_atomic_int_t path_cache_bytes;
+
     private:
     struct gname_t
     {
@@ -100,6 +100,89 @@ struct cff2_path_procs_extents_t : path_procs_t<cff2_path_procs_extents_t, cff2_
 
 struct cff2_cs_opset_extents_t : cff2_cs_opset_t<cff2_cs_opset_extents_t, cff2_extents_param_t, cff2_path_procs_extents_t> {};
 
+struct cff2_cs_opset_path_build_t : cff2_cs_opset_t<cff2_cs_opset_path_build_t, cs_path_builder_t,
+						    cs_path_procs_build_t<cff2_cs_interp_env_t, cs_path_builder_t>> {};
+
+/* The paths of the default instance are cached in the face, those of
+ * other instances in the font. */
+static cs_path_cache_t *
+_get_path_cache (const OT::cff2::accelerator_t *cff, hb_font_t *font)
+{
+  if (!font->num_coords)
+    return &cff->path_cache;
+#ifndef HB_NO_VAR
+  cs_path_cache_t *cache = _hb_ot_font_get_cff2_path_cache (font);
+  if (cache && cache->sync (font->serial_coords))
+    return cache;
+#endif
+  return nullptr;
+}
+
+/* Returns the path of @glyph at the coordinates of @font from the cache,
+ * decoding the charstring into it first if needed.  Returns nullptr if that
+ * fails or there is no cache to use; the charstring is then interpreted
+ * directly. */
+static const cs_path_t *
+_get_cs_path (const OT::cff2::accelerator_t *cff, hb_font_t *font, hb_codepoint_t glyph)
+{
+  cs_path_cache_t *cache = _get_path_cache (cff, font);
+  if (unlikely (!cache)) return nullptr;
+  const cs_path_t *path = cache->get (glyph);
+  if (likely (path) || cache->is_full ()) return path;
+
+  unsigned int fd = cff->fdSelect->get_fd (glyph);
+  cff2_cs_interpreter_t<cff2_cs_opset_path_build_t, cs_path_builder_t> interp;
+  const byte_str_t str = (*cff->charStrings)[glyph];
+  interp.env.init (str, *cff, fd, font->coords, font->num_coords);
+  cs_path_builder_t param;
+  param.init ();
+  if (likely (interp.interpret (param)))
+    path = cache->set (glyph, cff->num_glyphs, param);
+  param.fini ();
+  return path;
+}
+
+/* Computes bounds from a cached path the way cff2_path_procs_extents_t does. */
+struct cff2_extents_replay_t : cff2_extents_param_t
+{
+  void init ()
+  {
+    cff2_extents_param_t::init ();
+    current.init ();
+  }
+
+  void move_to (const point_t &p)
+  {
+    end_path ();
+    current = p;
+  }
+
+  void line_to (const point_t &p)
+  {
+    open_path ();
+    current = p;
+    update_bounds (p);
+  }
+
+  void cubic_to (const point_t &p1, const point_t &p2, const point_t &p3)
+  {
+    open_path ();
+    update_bounds (p1);
+    update_bounds (p2);
+    current = p3;
+    update_bounds (p3);
+  }
+
+  void open_path ()
+  {
+    if (is_path_open ()) return;
+    start_path ();
+    update_bounds (current);
+  }
+
+  point_t current;
+};
+
 bool OT::cff2::accelerator_t::get_extents (hb_font_t *font,
 					   hb_codepoint_t glyph,
 					   hb_glyph_extents_t *extents) const
@@ -111,13 +194,22 @@ bool OT::cff2::accelerator_t::get_extents (hb_font_t *font,
 
   if (unlikely (!is_valid () || (glyph >= num_glyphs))) return false;
 
-  unsigned int fd = fdSelect->get_fd (glyph);
-  cff2_cs_interpreter_t<cff2_cs_opset_extents_t, cff2_extents_param_t> interp;
-  const byte_str_t str = (*charStrings)[glyph];
-  interp.env.init (str, *this, fd, font->coords, font->num_coords);
-  cff2_extents_param_t  param;
+  cff2_extents_replay_t param;
   param.init ();
-  if (unlikely (!interp.interpret (param))) return false;
+  const cs_path_t *path = _get_cs_path (this, font, glyph);
+  if (likely (path))
+  {
+    cs_path_t::seac_t seac;
+    path->replay (param, seac);
+  }
+  else
+  {
+    unsigned int fd = fdSelect->get_fd (glyph);
+    cff2_cs_interpreter_t<cff2_cs_opset_extents_t, cff2_extents_param_t> interp;
+    const byte_str_t str = (*charStrings)[glyph];
+    interp.env.init (str, *this, fd, font->coords, font->num_coords);
+    if (unlikely (!interp.interpret (param))) return false;
+  }
 
   if (param.min_x >= param.max_x)
   {
@@ -202,11 +294,19 @@ bool OT::cff2::accelerator_t::get_path (hb_font_t *font, hb_codepoint_t glyph, d
 
   if (unlikely (!is_valid () || (glyph >= num_glyphs))) return false;
 
+  cff2_path_param_t param (font, draw_helper);
+  const cs_path_t *path = _get_cs_path (this, font, glyph);
+  if (likely (path))
+  {
+    cs_path_t::seac_t seac;
+    path->replay (param, seac);
+    return true;
+  }
+
   unsigned int fd = fdSelect->get_fd (glyph);
   cff2_cs_interpreter_t<cff2_cs_opset_path_t, cff2_path_param_t> interp;
   const byte_str_t str = (*charStrings)[glyph];
   interp.env.init (str, *this, fd, font->coords, font->num_coords);
-  cff2_path_param_t param (font, draw_helper);
   if (unlikely (!interp.interpret (param))) return false;
   return true;
 }
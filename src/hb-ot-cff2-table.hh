@@ -28,6 +28,7 @@
 #define HB_OT_CFF2_TABLE_HH
 
 #include "hb-ot-cff-common.hh"
+#include "hb-cff-interp-cs-common.hh"
 #include "hb-subset-cff2.hh"
 #include "hb-draw.hh"
 
@@ -504,12 +505,34 @@ struct cff2
 
   struct accelerator_t : accelerator_templ_t<cff2_private_dict_opset_t, cff2_private_dict_values_t>
   {
+    void init (hb_face_t *face)
+    {
+      SUPER::init (face);
+      path_cache_bytes.set_relaxed (0);
+      path_cache.init (&path_cache_bytes);
+    }
+
+    void fini ()
+    {
+      path_cache.stats.report (this, "cff2 path cache");
+      path_cache.fini ();
+      SUPER::fini ();
+    }
+
     HB_INTERNAL bool get_extents (hb_font_t *font,
 				  hb_codepoint_t glyph,
 				  hb_glyph_extents_t *extents) const;
 #ifdef HB_EXPERIMENTAL_API
     HB_INTERNAL bool get_path (hb_font_t *font, hb_codepoint_t glyph, draw_helper_t &draw_helper) const;
 #endif
+
+    /* Decoded glyph outlines of the default instance; see _get_cs_path().
+     * The caches of other instances, in the fonts, share its budget. */
+    mutable CFF::cs_path_cache_t path_cache;
+    mutable hb_atomic_int_t path_cache_bytes;
+
+    private:
+    typedef accelerator_templ_t<cff2_private_dict_opset_t, cff2_private_dict_values_t> SUPER;
   };
 
   typedef accelerator_templ_t<cff2_private_dict_opset_subset_t, cff2_private_dict_values_subset_t> accelerator_subset_t;
@@ -528,4 +551,10 @@ struct cff2
 struct cff2_accelerator_t : cff2::accelerator_t {};
 } /* namespace OT */
 
+#ifndef HB_NO_VAR
+/* Returns the cache of @font if it uses hb-ot-font and has variations. */
+HB_INTERNAL CFF::cs_path_cache_t *
+_hb_ot_font_get_cff2_path_cache (hb_font_t *font);
+#endif
+
 #endif /* HB_OT_CFF2_TABLE_HH */
@@ -29,6 +29,7 @@
 
 #include "hb-open-type.hh"
 #include "hb-set.hh"
+#include "hb-cache.hh"
 
 /*
  * cmap -- Character to Glyph Index Mapping
@@ -305,7 +306,7 @@ struct CmapSubtableFormat4
     }
     void fini () {}
 
-    bool get_glyph (hb_codepoint_t codepoint, hb_codepoint_t *glyph) const
+    bool find_segment (hb_codepoint_t codepoint, unsigned int *i) const
     {
       struct CustomRange
       {
@@ -327,8 +328,38 @@ struct CmapSubtableFormat4
 					  this->segCount + 1);
       if (!found)
 	return false;
-      unsigned int i = found - endCount;
+      *i = found - endCount;
+      return true;
+    }
+
+    bool get_glyph (hb_codepoint_t codepoint, hb_codepoint_t *glyph) const
+    {
+      unsigned int i;
+      if (!find_segment (codepoint, &i))
+	return false;
+      return get_glyph_from_segment (i, codepoint, glyph);
+    }
+
+    /* Same, but tries segment *last first, and updates it.  Running text
+     * mostly stays within one segment, so batch lookups skip the bsearch. */
+    bool get_glyph (hb_codepoint_t codepoint, hb_codepoint_t *glyph,
+		    unsigned int *last) const
+    {
+      unsigned int i = *last;
+      if (!(i < this->segCount &&
+	    this->startCount[i] <= codepoint && codepoint <= this->endCount[i]))
+      {
+	if (!find_segment (codepoint, &i))
+	  return false;
+	*last = i;
+      }
+      return get_glyph_from_segment (i, codepoint, glyph);
+    }
 
+    bool get_glyph_from_segment (unsigned int i,
+				 hb_codepoint_t codepoint,
+				 hb_codepoint_t *glyph) const
+    {
       hb_codepoint_t gid;
       unsigned int rangeOffset = this->idRangeOffset[i];
       if (rangeOffset == 0)
@@ -608,6 +639,24 @@ struct CmapSubtableLongSegmented
     return true;
   }
 
+  /* Same, but tries group *last first, and updates it. */
+  bool get_glyph (hb_codepoint_t codepoint, hb_codepoint_t *glyph,
+		  unsigned int *last) const
+  {
+    unsigned int i = *last;
+    if (!(i < groups.len && groups.arrayZ[i].cmp (codepoint) == 0))
+    {
+      if (!groups.bfind (codepoint, &i))
+	return false;
+      *last = i;
+    }
+    hb_codepoint_t gid = T::group_get_glyph (groups.arrayZ[i], codepoint);
+    if (!gid)
+      return false;
+    *glyph = gid;
+    return true;
+  }
+
   void collect_unicodes (hb_set_t *out, unsigned int num_glyphs) const
   {
     for (unsigned int i = 0; i < this->groups.len; i++)
@@ -1496,6 +1545,7 @@ struct cmap
       }
 
       this->get_glyph_data = subtable;
+      this->get_glyphs_funcZ = nullptr;
       if (unlikely (symbol))
 	this->get_glyph_funcZ = get_glyph_from_symbol<CmapSubtable>;
       else
@@ -1507,12 +1557,14 @@ struct cmap
 	  break;
 	case 12:
 	  this->get_glyph_funcZ = get_glyph_from<CmapSubtableFormat12>;
+	  this->get_glyphs_funcZ = get_glyphs_from<CmapSubtableFormat12>;
 	  break;
 	case  4:
 	{
 	  this->format4_accel.init (&subtable->u.format4);
 	  this->get_glyph_data = &this->format4_accel;
 	  this->get_glyph_funcZ = this->format4_accel.get_glyph_func;
+	  this->get_glyphs_funcZ = get_glyphs_from<CmapSubtableFormat4::accelerator_t>;
 	  break;
 	}
 	}
@@ -1522,27 +1574,56 @@ struct cmap
     void fini () { this->table.destroy (); }
 
     bool get_nominal_glyph (hb_codepoint_t  unicode,
-			    hb_codepoint_t *glyph) const
+			    hb_codepoint_t *glyph,
+			    hb_cmap_cache_t *cache = nullptr) const
     {
       if (unlikely (!this->get_glyph_funcZ)) return false;
-      return this->get_glyph_funcZ (this->get_glyph_data, unicode, glyph);
+
+      unsigned int cached;
+      if (cache && cache->get (unicode, &cached))
+      {
+	*glyph = cached;
+	return true;
+      }
+      if (!this->get_glyph_funcZ (this->get_glyph_data, unicode, glyph))
+	return false;
+      if (cache)
+	cache->set (unicode, *glyph);
+      return true;
     }
     unsigned int get_nominal_glyphs (unsigned int count,
 				     const hb_codepoint_t *first_unicode,
 				     unsigned int unicode_stride,
 				     hb_codepoint_t *first_glyph,
-				     unsigned int glyph_stride) const
+				     unsigned int glyph_stride,
+				     hb_cmap_cache_t *cache = nullptr) const
     {
       if (unlikely (!this->get_glyph_funcZ)) return 0;
 
+      if (this->get_glyphs_funcZ)
+	return this->get_glyphs_funcZ (this->get_glyph_data, count,
+				       first_unicode, unicode_stride,
+				       first_glyph, glyph_stride,
+				       cache);
+
       hb_cmap_get_glyph_func_t get_glyph_funcZ = this->get_glyph_funcZ;
       const void *get_glyph_data = this->get_glyph_data;
 
       unsigned int done;
-      for (done = 0;
-	   done < count && get_glyph_funcZ (get_glyph_data, *first_unicode, first_glyph);
-	   done++)
+      for (done = 0; done < count; done++)
       {
+	hb_codepoint_t unicode = *first_unicode;
+	unsigned int cached;
+	if (cache && cache->get (unicode, &cached))
+	  *first_glyph = cached;
+	else
+	{
+	  if (!get_glyph_funcZ (get_glyph_data, unicode, first_glyph))
+	    break;
+	  if (cache)
+	    cache->set (unicode, *first_glyph);
+	}
+
 	first_unicode = &StructAtOffsetUnaligned<hb_codepoint_t> (first_unicode, unicode_stride);
 	first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
       }
@@ -1590,6 +1671,49 @@ struct cmap
       return typed_obj->get_glyph (codepoint, glyph);
     }
 
+    typedef unsigned int (*hb_cmap_get_glyphs_func_t) (const void *obj,
+						       unsigned int count,
+						       const hb_codepoint_t *first_unicode,
+						       unsigned int unicode_stride,
+						       hb_codepoint_t *first_glyph,
+						       unsigned int glyph_stride,
+						       hb_cmap_cache_t *cache);
+
+    /* Batch version of get_glyph_from() for subtables that can remember
+     * the segment / group of the previous lookup. */
+    template <typename Type>
+    HB_INTERNAL static unsigned int get_glyphs_from (const void *obj,
+						     unsigned int count,
+						     const hb_codepoint_t *first_unicode,
+						     unsigned int unicode_stride,
+						     hb_codepoint_t *first_glyph,
+						     unsigned int glyph_stride,
+						     hb_cmap_cache_t *cache)
+    {
+      const Type *typed_obj = (const Type *) obj;
+      unsigned int last = (unsigned int) -1;
+
+      unsigned int done;
+      for (done = 0; done < count; done++)
+      {
+	hb_codepoint_t unicode = *first_unicode;
+	unsigned int cached;
+	if (cache && cache->get (unicode, &cached))
+	  *first_glyph = cached;
+	else
+	{
+	  if (!typed_obj->get_glyph (unicode, first_glyph, &last))
+	    break;
+	  if (cache)
+	    cache->set (unicode, *first_glyph);
+	}
+
+	first_unicode = &StructAtOffsetUnaligned<hb_codepoint_t> (first_unicode, unicode_stride);
+	first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+      }
+      return done;
+    }
+
     template <typename Type>
     HB_INTERNAL static bool get_glyph_from_symbol (const void *obj,
 						   hb_codepoint_t codepoint,
@@ -1617,6 +1741,7 @@ struct cmap
     hb_nonnull_ptr_t<const CmapSubtableFormat14> subtable_uvs;
 
     hb_cmap_get_glyph_func_t get_glyph_funcZ;
+    hb_cmap_get_glyphs_func_t get_glyphs_funcZ;
     const void *get_glyph_data;
 
     CmapSubtableFormat4::accelerator_t format4_accel;
@@ -30,6 +30,7 @@
 
 #include "hb-ot.h"
 
+#include "hb-cache.hh"
 #include "hb-font.hh"
 #include "hb-machinery.hh"
 #include "hb-ot-face.hh"
@@ -59,6 +60,237 @@
  **/
 
 
+/* Lazily allocated cache of unscaled glyph advances.  Only used when
+ * the font has variations, in which case computing an advance means
+ * evaluating HVAR / VVAR or the glyf phantom points.  Flushed whenever
+ * the font's variation coordinates change. */
+struct hb_ot_font_advance_cache_t
+{
+  void init ()
+  {
+    cache.init ();
+    serial_coords.set_relaxed (0);
+  }
+  void fini (const void *obj HB_UNUSED, const char *name HB_UNUSED)
+  {
+    hb_advance_cache_t *c = cache.get_relaxed ();
+    if (!c) return;
+    c->stats.report (obj, name);
+    c->fini ();
+    hb_free (c);
+  }
+
+  hb_advance_cache_t *get (const hb_font_t *font) const
+  {
+  retry:
+    hb_advance_cache_t *c = cache.get ();
+    if (unlikely (!c))
+    {
+      c = (hb_advance_cache_t *) hb_calloc (1, sizeof (hb_advance_cache_t));
+      if (unlikely (!c))
+	return nullptr;
+      c->init ();
+      if (unlikely (!cache.cmpexch (nullptr, c)))
+      {
+	hb_free (c);
+	goto retry;
+      }
+      serial_coords.set_relaxed (font->serial_coords);
+    }
+
+    if ((unsigned) serial_coords.get_relaxed () != font->serial_coords)
+    {
+      c->clear ();
+      serial_coords.set_relaxed (font->serial_coords);
+    }
+    return c;
+  }
+
+  private:
+  hb_atomic_ptr_t<hb_advance_cache_t> cache;
+  mutable hb_atomic_int_t serial_coords;
+};
+
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+/* Lazily allocated cache of glyph extents, as returned by the font
+ * functions, so already scaled.  Layout and fallback mark positioning ask
+ * for the extents of the same glyphs over and over, and for composite,
+ * CFF or variable glyphs computing them means walking the outline.
+ * Direct-mapped by glyph id; a glyph evicts whatever shares its slot.
+ * Each slot is a seqlock: its one writer at a time keeps its sequence
+ * number odd while writing, and readers that saw it odd or changed treat
+ * the lookup as a miss instead of retrying.  The cache is flushed
+ * the first time it is used after the font changes in any way (scale,
+ * ppem, variations...), keyed off hb_font_t::serial; like the other
+ * caches, that relies on the font not being changed while in use. */
+struct hb_ot_font_extents_cache_t
+{
+  static constexpr unsigned CACHE_BITS = 9;
+
+  void init ()
+  {
+    entries.init ();
+    flushing.init ();
+    serial.set_relaxed (0);
+    stats.init ();
+  }
+  void fini (const void *obj HB_UNUSED)
+  {
+    stats.report (obj, "extents cache");
+    stats.fini ();
+    hb_free (entries.get_relaxed ());
+  }
+
+  bool get (const hb_font_t *font, hb_codepoint_t glyph, hb_glyph_extents_t *extents) const
+  {
+    const entry_t *e = sync (font);
+    if (unlikely (!e)) return false;
+    e += glyph & ((1u << CACHE_BITS) - 1);
+    int seq = e->seq.get ();
+    unsigned glyph_plus_one = e->glyph_plus_one.get_relaxed ();
+    hb_glyph_extents_t cached = {e->x_bearing.get_relaxed (),
+				 e->y_bearing.get_relaxed (),
+				 e->width.get_relaxed (),
+				 e->height.get_relaxed ()};
+    _hb_memory_r_barrier ();
+    if ((seq & 1) || e->seq.get_relaxed () != seq || glyph_plus_one != glyph + 1)
+    {
+      stats.miss ();
+      return false;
+    }
+    stats.hit ();
+    *extents = cached;
+    return true;
+  }
+
+  void set (const hb_font_t *font, hb_codepoint_t glyph, const hb_glyph_extents_t &extents) const
+  {
+    entry_t *e = sync (font);
+    if (unlikely (!e)) return;
+    e += glyph & ((1u << CACHE_BITS) - 1);
+    /* Only one thread writes a slot at a time; the others don't wait. */
+    if (e->writing.get_relaxed () || e->writing.inc ())
+      return;
+    int seq = e->seq.get_relaxed ();
+    e->seq.set_relaxed (seq + 1);
+    _hb_memory_w_barrier ();
+    e->glyph_plus_one.set_relaxed (glyph + 1);
+    e->x_bearing.set_relaxed (extents.x_bearing);
+    e->y_bearing.set_relaxed (extents.y_bearing);
+    e->width.set_relaxed (extents.width);
+    e->height.set_relaxed (extents.height);
+    e->seq.set (seq + 2);
+    e->writing.set (0);
+  }
+
+  hb_cache_stats_t stats;
+
+  private:
+  struct entry_t
+  {
+    hb_atomic_int_t writing;
+    hb_atomic_int_t seq; /* Odd while being written. */
+    hb_atomic_int_t glyph_plus_one; /* Zero if empty. */
+    hb_atomic_int_t x_bearing;
+    hb_atomic_int_t y_bearing;
+    hb_atomic_int_t width;
+    hb_atomic_int_t height;
+  };
+
+  /* Returns the entries, allocating or flushing them first if needed;
+   * nullptr if the cache cannot be used right now. */
+  entry_t *sync (const hb_font_t *font) const
+  {
+    entry_t *e = entries.get ();
+    if (likely (e && (unsigned) serial.get () == font->serial))
+      return e;
+
+    if (!flushing.cmpexch (nullptr, (void *) this))
+      return nullptr;
+    /* Someone else may have flushed while we were looking. */
+    e = entries.get ();
+    if (!e)
+    {
+      e = (entry_t *) hb_calloc (1u << CACHE_BITS, sizeof (entry_t));
+      if (likely (e))
+	entries.cmpexch (nullptr, e);
+    }
+    else if ((unsigned) serial.get () != font->serial)
+      memset ((void *) e, 0, (1u << CACHE_BITS) * sizeof (entry_t));
+    serial.set (font->serial);
+    flushing.set_relaxed (nullptr);
+    return e;
+  }
+
+  hb_atomic_ptr_t<entry_t> entries;
+  mutable hb_atomic_ptr_t<void> flushing;
+  mutable hb_atomic_int_t serial;
+};
+#endif
+
+struct hb_ot_font_t
+{
+  hb_face_t *face; /* Referenced, as the caches below may charge it. */
+  const hb_ot_face_t *ot_face;
+
+  /* Per-font caches; see hb-cache.hh. */
+  mutable hb_cmap_cache_t cmap_cache;
+  hb_ot_font_advance_cache_t h_advance_cache;
+  hb_ot_font_advance_cache_t v_advance_cache;
+#ifndef HB_NO_VAR
+  mutable hb_glyf_points_cache_t glyf_points_cache;
+  mutable CFF::cs_path_cache_t cff2_path_cache;
+#endif
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  hb_ot_font_extents_cache_t extents_cache;
+#endif
+};
+
+static hb_ot_font_t *
+_hb_ot_font_create (hb_font_t *font)
+{
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) hb_calloc (1, sizeof (hb_ot_font_t));
+  if (unlikely (!ot_font)) return nullptr;
+
+  ot_font->face = hb_face_reference (font->face);
+  ot_font->ot_face = &ot_font->face->table;
+  ot_font->cmap_cache.init ();
+  ot_font->h_advance_cache.init ();
+  ot_font->v_advance_cache.init ();
+#ifndef HB_NO_VAR
+  ot_font->glyf_points_cache.init ();
+  ot_font->cff2_path_cache.init ();
+#endif
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  ot_font->extents_cache.init ();
+#endif
+
+  return ot_font;
+}
+
+static void
+_hb_ot_font_destroy (void *data)
+{
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) data;
+
+  ot_font->cmap_cache.stats.report (ot_font, "cmap cache");
+  ot_font->cmap_cache.fini ();
+  ot_font->h_advance_cache.fini (ot_font, "h-advance cache");
+  ot_font->v_advance_cache.fini (ot_font, "v-advance cache");
+#ifndef HB_NO_VAR
+  ot_font->glyf_points_cache.stats.report (ot_font, "glyf points cache");
+  ot_font->glyf_points_cache.fini ();
+  ot_font->cff2_path_cache.stats.report (ot_font, "cff2 path cache");
+  ot_font->cff2_path_cache.fini ();
+#endif
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  ot_font->extents_cache.fini (ot_font);
+#endif
+
+  hb_face_destroy (ot_font->face);
+  hb_free (ot_font);
+}
+
 static hb_bool_t
 hb_ot_get_nominal_glyph (hb_font_t *font HB_UNUSED,
 			 void *font_data,
@@ -66,8 +298,9 @@ hb_ot_get_nominal_glyph (hb_font_t *font HB_UNUSED,
 			 hb_codepoint_t *glyph,
 			 void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
-  return ot_face->cmap->get_nominal_glyph (unicode, glyph);
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
+  return ot_face->cmap->get_nominal_glyph (unicode, glyph, &ot_font->cmap_cache);
 }
 
 static unsigned int
@@ -80,10 +313,12 @@ hb_ot_get_nominal_glyphs (hb_font_t *font HB_UNUSED,
 			  unsigned int glyph_stride,
 			  void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
   return ot_face->cmap->get_nominal_glyphs (count,
 					    first_unicode, unicode_stride,
-					    first_glyph, glyph_stride);
+					    first_glyph, glyph_stride,
+					    &ot_font->cmap_cache);
 }
 
 static hb_bool_t
@@ -94,7 +329,8 @@ hb_ot_get_variation_glyph (hb_font_t *font HB_UNUSED,
 			   hb_codepoint_t *glyph,
 			   void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
   return ot_face->cmap->get_variation_glyph (unicode, variation_selector, glyph);
 }
 
@@ -107,12 +343,21 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
 			    unsigned advance_stride,
 			    void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
   const OT::hmtx_accelerator_t &hmtx = *ot_face->hmtx;
+  hb_advance_cache_t *cache = font->num_coords ? ot_font->h_advance_cache.get (font) : nullptr;
 
   for (unsigned int i = 0; i < count; i++)
   {
-    *first_advance = font->em_scale_x (hmtx.get_advance (*first_glyph, font));
+    unsigned int advance;
+    if (!cache || !cache->get (*first_glyph, &advance))
+    {
+      advance = hmtx.get_advance (*first_glyph, font);
+      if (cache)
+	cache->set (*first_glyph, advance);
+    }
+    *first_advance = font->em_scale_x (advance);
     first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
     first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
   }
@@ -127,12 +372,21 @@ hb_ot_get_glyph_v_advances (hb_font_t* font, void* font_data,
 			    unsigned advance_stride,
 			    void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
   const OT::vmtx_accelerator_t &vmtx = *ot_face->vmtx;
+  hb_advance_cache_t *cache = font->num_coords ? ot_font->v_advance_cache.get (font) : nullptr;
 
   for (unsigned int i = 0; i < count; i++)
   {
-    *first_advance = font->em_scale_y (-(int) vmtx.get_advance (*first_glyph, font));
+    unsigned int advance;
+    if (!cache || !cache->get (*first_glyph, &advance))
+    {
+      advance = vmtx.get_advance (*first_glyph, font);
+      if (cache)
+	cache->set (*first_glyph, advance);
+    }
+    *first_advance = font->em_scale_y (-(int) advance);
     first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
     first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
   }
@@ -146,7 +400,8 @@ hb_ot_get_glyph_v_origin (hb_font_t *font,
 			  hb_position_t *y,
 			  void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
 
   *x = font->get_glyph_h_advance (glyph) / 2;
 
@@ -175,15 +430,12 @@ hb_ot_get_glyph_v_origin (hb_font_t *font,
   return true;
 }
 
-static hb_bool_t
-hb_ot_get_glyph_extents (hb_font_t *font,
-			 void *font_data,
-			 hb_codepoint_t glyph,
-			 hb_glyph_extents_t *extents,
-			 void *user_data HB_UNUSED)
+static bool
+_hb_ot_get_glyph_extents (hb_font_t *font,
+			  const hb_ot_face_t *ot_face,
+			  hb_codepoint_t glyph,
+			  hb_glyph_extents_t *extents)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
-
 #if !defined(HB_NO_OT_FONT_BITMAP) && !defined(HB_NO_COLOR)
   if (ot_face->sbix->get_extents (font, glyph, extents)) return true;
 #endif
@@ -200,6 +452,25 @@ hb_ot_get_glyph_extents (hb_font_t *font,
   return false;
 }
 
+static hb_bool_t
+hb_ot_get_glyph_extents (hb_font_t *font,
+			 void *font_data,
+			 hb_codepoint_t glyph,
+			 hb_glyph_extents_t *extents,
+			 void *user_data HB_UNUSED)
+{
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  if (ot_font->extents_cache.get (font, glyph, extents)) return true;
+#endif
+  if (!_hb_ot_get_glyph_extents (font, ot_font->ot_face, glyph, extents)) return false;
+#ifndef HB_NO_OT_FONT_EXTENTS_CACHE
+  ot_font->extents_cache.set (font, glyph, *extents);
+#endif
+  return true;
+}
+
 #ifndef HB_NO_OT_FONT_GLYPH_NAMES
 static hb_bool_t
 hb_ot_get_glyph_name (hb_font_t *font HB_UNUSED,
@@ -208,7 +479,8 @@ hb_ot_get_glyph_name (hb_font_t *font HB_UNUSED,
 		      char *name, unsigned int size,
 		      void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
   if (ot_face->post->get_glyph_name (glyph, name, size)) return true;
 #ifndef HB_NO_OT_FONT_CFF
   if (ot_face->cff1->get_glyph_name (glyph, name, size)) return true;
@@ -222,7 +494,8 @@ hb_ot_get_glyph_from_name (hb_font_t *font HB_UNUSED,
 			   hb_codepoint_t *glyph,
 			   void *user_data HB_UNUSED)
 {
-  const hb_ot_face_t *ot_face = (const hb_ot_face_t *) font_data;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
   if (ot_face->post->get_glyph_from_name (name, len, glyph)) return true;
 #ifndef HB_NO_OT_FONT_CFF
     if (ot_face->cff1->get_glyph_from_name (name, len, glyph)) return true;
@@ -315,13 +588,41 @@ _hb_ot_get_font_funcs ()
 void
 hb_ot_font_set_funcs (hb_font_t *font)
 {
+  hb_ot_font_t *ot_font = _hb_ot_font_create (font);
+  if (unlikely (!ot_font))
+    return;
+
   hb_font_set_funcs (font,
 		     _hb_ot_get_font_funcs (),
-		     &font->face->table,
-		     nullptr);
+		     ot_font,
+		     _hb_ot_font_destroy);
 }
 
 #ifndef HB_NO_VAR
+hb_glyf_points_cache_t *
+_hb_ot_font_get_glyf_points_cache (hb_font_t *font)
+{
+  if (!font->num_coords || font->klass != _hb_ot_get_font_funcs ())
+    return nullptr;
+  return &((hb_ot_font_t *) font->user_data)->glyf_points_cache;
+}
+
+CFF::cs_path_cache_t *
+_hb_ot_font_get_cff2_path_cache (hb_font_t *font)
+{
+#ifndef HB_NO_CFF
+  if (!font->num_coords || font->klass != _hb_ot_get_font_funcs ())
+    return nullptr;
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) font->user_data;
+  /* Counted against the face the font data holds on to, even if the
+   * font has since moved to another one. */
+  ot_font->cff2_path_cache.set_budget (&ot_font->ot_face->cff2->path_cache_bytes);
+  return &ot_font->cff2_path_cache;
+#else
+  return nullptr;
+#endif
+}
+
 int
 _glyf_get_side_bearing_var (hb_font_t *font, hb_codepoint_t glyph, bool is_vertical)
 {
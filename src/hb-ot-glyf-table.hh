@@ -35,6 +35,108 @@
 #include "hb-ot-hmtx-table.hh"
 #include "hb-ot-var-gvar-table.hh"
 #include "hb-draw.hh"
+#include "hb-cache.hh"
+
+
+#ifndef HB_NO_VAR
+/* Lockfree per-font cache of the fully varied points, phantom points
+ * included, of glyf glyphs.  Direct-mapped by glyph id; a slot, once
+ * filled, is kept until the font's variation coordinates change, so
+ * readers never see an entry freed under them.  Flushing needs that
+ * no other thread is using the cache at the time, which holds as the
+ * coordinates may only be changed while the font is not in use; the
+ * first thread to notice the change flushes, the rest skip the cache
+ * until it is done. */
+struct hb_glyf_points_cache_t
+{
+  static constexpr unsigned CACHE_BITS = 8;
+
+  struct entry_t
+  {
+    hb_codepoint_t gid;
+    unsigned length;
+    OT::contour_point_t points[HB_VAR_ARRAY];
+  };
+
+  void init ()
+  {
+    for (unsigned i = 0; i < ARRAY_LENGTH (entries); i++)
+      entries[i].init ();
+    flushing.init ();
+    serial_coords.set_relaxed (0);
+    stats.init ();
+  }
+  void fini ()
+  {
+    clear ();
+    stats.fini ();
+  }
+
+  /* Returns false if the cache cannot be used right now. */
+  bool sync (const hb_font_t *font)
+  {
+    if (likely ((unsigned) serial_coords.get () == font->serial_coords))
+      return true;
+
+    if (!flushing.cmpexch (nullptr, this))
+      return false;
+    /* Someone else may have flushed while we were looking. */
+    if ((unsigned) serial_coords.get () != font->serial_coords)
+    {
+      clear ();
+      serial_coords.set (font->serial_coords);
+    }
+    flushing.set_relaxed (nullptr);
+    return true;
+  }
+
+  hb_array_t<const OT::contour_point_t> get (hb_codepoint_t gid) const
+  {
+    const entry_t *e = entries[gid & ((1u << CACHE_BITS) - 1)].get ();
+    if (!e || e->gid != gid)
+    {
+      stats.miss ();
+      return hb_array_t<const OT::contour_point_t> ();
+    }
+    stats.hit ();
+    return hb_array (e->points, e->length);
+  }
+
+  void set (hb_codepoint_t gid, hb_array_t<const OT::contour_point_t> points)
+  {
+    hb_atomic_ptr_t<entry_t> &slot = entries[gid & ((1u << CACHE_BITS) - 1)];
+    if (slot.get_relaxed ()) return;
+
+    entry_t *e = (entry_t *) hb_malloc (offsetof (entry_t, points) + points.get_size ());
+    if (unlikely (!e)) return;
+    e->gid = gid;
+    e->length = points.length;
+    memcpy (e->points, points.arrayZ, points.get_size ());
+    if (!slot.cmpexch (nullptr, e))
+      hb_free (e);
+  }
+
+  hb_cache_stats_t stats;
+
+  private:
+  void clear ()
+  {
+    for (unsigned i = 0; i < ARRAY_LENGTH (entries); i++)
+    {
+      hb_free (entries[i].get_relaxed ());
+      entries[i].set_relaxed (nullptr);
+    }
+  }
+
+  hb_atomic_ptr_t<entry_t> entries[1u << CACHE_BITS];
+  hb_atomic_ptr_t<void> flushing;
+  hb_atomic_int_t serial_coords;
+};
+
+/* Returns the cache of @font if it uses hb-ot-font and has variations. */
+HB_INTERNAL hb_glyf_points_cache_t *
+_hb_ot_font_get_glyf_points_cache (hb_font_t *font);
+#endif
 
 namespace OT {
 
@@ -914,6 +1016,8 @@ struct glyf
       glyf_table.destroy ();
     }
 
+    bool has_data () const { return num_glyphs; }
+
     protected:
     template<typename T>
     bool get_points (hb_font_t *font, hb_codepoint_t gid, T consumer) const
@@ -924,11 +1028,26 @@ struct glyf
 	 https://github.com/harfbuzz/harfbuzz/issues/2095
 	 mostly because of gvar handling in VF fonts,
 	 perhaps a separate path for non-VF fonts can be considered */
-      contour_point_vector_t all_points;
+      contour_point_vector_t all_points_vector;
+      hb_array_t<const contour_point_t> all_points;
 
       bool phantom_only = !consumer.is_consuming_contour_points ();
-      if (unlikely (!glyph_for_gid (gid).get_points (font, *this, all_points, phantom_only)))
-	return false;
+#ifndef HB_NO_VAR
+      hb_glyf_points_cache_t *cache = _hb_ot_font_get_glyf_points_cache (font);
+      if (cache && !cache->sync (font)) cache = nullptr;
+      if (cache) all_points = cache->get (gid);
+#endif
+      if (!all_points.length)
+      {
+	if (unlikely (!glyph_for_gid (gid).get_points (font, *this, all_points_vector, phantom_only)))
+	  return false;
+	all_points = all_points_vector.as_array ();
+#ifndef HB_NO_VAR
+	/* Phantom-only points are not worth keeping. */
+	if (cache && !phantom_only)
+	  cache->set (gid, all_points);
+#endif
+      }
 
       if (consumer.is_consuming_contour_points ())
       {
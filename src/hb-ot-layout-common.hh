@@ -2562,9 +2562,12 @@ struct VarData
   unsigned int get_size () const
   { return itemCount * get_row_size (); }
 
+  /* region_scalars, if not empty, holds regions.evaluate() of each
+   * region at coords. */
   float get_delta (unsigned int inner,
 		   const int *coords, unsigned int coord_count,
-		   const VarRegionList &regions) const
+		   const VarRegionList &regions,
+		   hb_array_t<const float> region_scalars = hb_array_t<const float> ()) const
   {
     if (unlikely (inner >= itemCount))
       return 0.;
@@ -2581,13 +2584,17 @@ struct VarData
    const HBINT16 *scursor = reinterpret_cast<const HBINT16 *> (row);
    for (; i < scount; i++)
    {
-     float scalar = regions.evaluate (regionIndices.arrayZ[i], coords, coord_count);
+     unsigned int region = regionIndices.arrayZ[i];
+     float scalar = region < region_scalars.length ? region_scalars[region]
+						   : regions.evaluate (region, coords, coord_count);
      delta += scalar * *scursor++;
    }
    const HBINT8 *bcursor = reinterpret_cast<const HBINT8 *> (scursor);
    for (; i < count; i++)
    {
-     float scalar = regions.evaluate (regionIndices.arrayZ[i], coords, coord_count);
+     unsigned int region = regionIndices.arrayZ[i];
+     float scalar = region < region_scalars.length ? region_scalars[region]
+						   : regions.evaluate (region, coords, coord_count);
      delta += scalar * *bcursor++;
    }
 
@@ -2736,7 +2743,8 @@ struct VariationStore
 {
   private:
   float get_delta (unsigned int outer, unsigned int inner,
-		   const int *coords, unsigned int coord_count) const
+		   const int *coords, unsigned int coord_count,
+		   hb_array_t<const float> region_scalars = hb_array_t<const float> ()) const
   {
 #ifdef HB_NO_VAR
     return 0.f;
@@ -2747,7 +2755,8 @@ struct VariationStore
 
     return (this+dataSets[outer]).get_delta (inner,
 					     coords, coord_count,
-					     this+regions);
+					     this+regions,
+					     region_scalars);
   }
 
   public:
@@ -2759,6 +2768,28 @@ struct VariationStore
     return get_delta (outer, inner, coords, coord_count);
   }
 
+  /* Same, at the coordinates of font, reusing its region scalars. */
+  float get_delta (unsigned int index, hb_font_t *font) const
+  {
+#ifdef HB_NO_VAR
+    return 0.f;
+#endif
+
+    if (!font->num_coords)
+      return get_delta (index, font->coords, font->num_coords);
+
+    const VarRegionList &region_list = this+regions;
+    const int *coords = font->coords;
+    unsigned int coord_count = font->num_coords;
+    hb_array_t<const float> region_scalars =
+      font->var_scalars.get (&region_list, region_list.get_region_count (),
+			     [&] (unsigned i) { return region_list.evaluate (i, coords, coord_count); });
+
+    unsigned int outer = index >> 16;
+    unsigned int inner = index & 0xFFFF;
+    return get_delta (outer, inner, coords, coord_count, region_scalars);
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
 #ifdef HB_NO_VAR
@@ -3384,7 +3415,7 @@ struct VariationDevice
 
   float get_delta (hb_font_t *font, const VariationStore &store) const
   {
-    return store.get_delta (varIdx, font->coords, font->num_coords);
+    return store.get_delta (varIdx, font);
   }
 
   protected:
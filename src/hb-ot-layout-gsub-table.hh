@@ -805,6 +805,11 @@ struct Ligature
     return true;
   }
 
+  /* Whether matching can get past the second component, if the glyph
+   * it is matched against is @glyph. */
+  bool may_match_second (hb_codepoint_t glyph) const
+  { return component.lenP1 <= 1 || component[1] == glyph; }
+
   bool apply (hb_ot_apply_context_t *c) const
   {
     TRACE_APPLY (this);
@@ -931,13 +936,42 @@ struct LigatureSet
     ;
   }
 
+  /* Finds the glyph match_input() checks the second component of the
+   * ligatures against, or -1 if there is none.  Fails if a glyph before
+   * it may or may not be skipped, as then that depends on the ligature. */
+  static bool get_second_glyph (hb_ot_apply_context_t *c, hb_codepoint_t *glyph)
+  {
+    hb_buffer_t *buffer = c->buffer;
+    const hb_ot_apply_context_t::skipping_iterator_t &skippy_iter = c->iter_input;
+    for (unsigned int i = buffer->idx + 1; i < buffer->len; i++)
+      switch (skippy_iter.may_skip (buffer->info[i]))
+      {
+	case hb_ot_apply_context_t::matcher_t::SKIP_YES:
+	  continue;
+	case hb_ot_apply_context_t::matcher_t::SKIP_NO:
+	  *glyph = buffer->info[i].codepoint;
+	  return true;
+	case hb_ot_apply_context_t::matcher_t::SKIP_MAYBE:
+	  return false;
+      }
+    *glyph = (hb_codepoint_t) -1;
+    return true;
+  }
+
   bool apply (hb_ot_apply_context_t *c) const
   {
     TRACE_APPLY (this);
     unsigned int num_ligs = ligature.len;
+
+    /* Most ligatures tried fail on their second component; check that
+     * here, instead of setting up matching the whole ligature. */
+    hb_codepoint_t second;
+    bool filter = get_second_glyph (c, &second);
+
     for (unsigned int i = 0; i < num_ligs; i++)
     {
       const Ligature &lig = this+ligature[i];
+      if (filter && !lig.may_match_second (second)) continue;
       if (lig.apply (c)) return_trace (true);
     }
 
@@ -611,6 +611,10 @@ struct hb_ot_apply_context_t :
 
   uint32_t random_state;
 
+  /* Glyphs that may be in the buffer.  Set up by update_digest(), and
+   * kept up to date as glyphs are substituted. */
+  hb_set_digest_t digest;
+
 
   hb_ot_apply_context_t (unsigned int table_index_,
 			 hb_font_t *font_,
@@ -636,7 +640,7 @@ struct hb_ot_apply_context_t :
 			auto_zwnj (true),
 			auto_zwj (true),
 			random (false),
-			random_state (1) { init_iters (); }
+			random_state (1) { init_iters (); digest.init (); }
 
   void init_iters ()
   {
@@ -651,6 +655,11 @@ struct hb_ot_apply_context_t :
   void set_recurse_func (recurse_func_t func) { recurse_func = func; }
   void set_lookup_index (unsigned int lookup_index_) { lookup_index = lookup_index_; }
   void set_lookup_props (unsigned int lookup_props_) { lookup_props = lookup_props_; init_iters (); }
+  void update_digest ()
+  {
+    digest.init ();
+    digest.add_array (&buffer->info[0].codepoint, buffer->len, sizeof (buffer->info[0]));
+  }
 
   uint32_t random_number ()
   {
@@ -700,8 +709,10 @@ struct hb_ot_apply_context_t :
   void _set_glyph_props (hb_codepoint_t glyph_index,
 			  unsigned int class_guess = 0,
 			  bool ligature = false,
-			  bool component = false) const
+			  bool component = false)
   {
+    digest.add (glyph_index);
+
     unsigned int add_in = _hb_glyph_info_get_glyph_props (&buffer->cur()) &
 			  HB_OT_LAYOUT_GLYPH_PROPS_PRESERVE;
     add_in |= HB_OT_LAYOUT_GLYPH_PROPS_SUBSTITUTED;
@@ -724,24 +735,24 @@ struct hb_ot_apply_context_t :
       _hb_glyph_info_set_glyph_props (&buffer->cur(), add_in | class_guess);
   }
 
-  void replace_glyph (hb_codepoint_t glyph_index) const
+  void replace_glyph (hb_codepoint_t glyph_index)
   {
     _set_glyph_props (glyph_index);
     (void) buffer->replace_glyph (glyph_index);
   }
-  void replace_glyph_inplace (hb_codepoint_t glyph_index) const
+  void replace_glyph_inplace (hb_codepoint_t glyph_index)
   {
     _set_glyph_props (glyph_index);
     buffer->cur().codepoint = glyph_index;
   }
   void replace_glyph_with_ligature (hb_codepoint_t glyph_index,
-				    unsigned int class_guess) const
+				    unsigned int class_guess)
   {
     _set_glyph_props (glyph_index, class_guess, true);
     (void) buffer->replace_glyph (glyph_index);
   }
   void output_glyph_for_component (hb_codepoint_t glyph_index,
-				   unsigned int class_guess) const
+				   unsigned int class_guess)
   {
     _set_glyph_props (glyph_index, class_guess, false, true);
     (void) buffer->output_glyph (glyph_index);
@@ -3500,6 +3511,8 @@ struct hb_ot_layout_lookup_accelerator_t
 
   bool may_have (hb_codepoint_t g) const
   { return digest.may_have (g); }
+  bool may_have (const hb_set_digest_t &glyphs) const
+  { return digest.may_have (glyphs); }
 
   bool apply (hb_ot_apply_context_t *c) const
   {
@@ -3720,7 +3733,7 @@ struct GSUBGPOS
     if (version.to_int () >= 0x00010001u)
       (this+featureVars).closure_features (lookup_indices, &alternate_feature_indices);
     if (unlikely (alternate_feature_indices.in_error())) {
-      feature_indices->successful = false;
+      feature_indices->err ();
       return;
     }
 #endif
@@ -1443,6 +1443,9 @@ hb_ot_layout_delete_glyphs_inplace (hb_buffer_t *buffer,
   {
     if (filter (&info[i]))
     {
+      if (!buffer->tracks_clusters ())
+	continue;
+
       /* Merge clusters.
        * Same logic as buffer->delete_glyph(), but for in-place removal. */
 
@@ -1914,6 +1917,7 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
   unsigned int i = 0;
   OT::hb_ot_apply_context_t c (table_index, font, buffer);
   c.set_recurse_func (Proxy::Lookup::apply_recurse_func);
+  c.update_digest ();
 
   for (unsigned int stage_index = 0; stage_index < stages[table_index].length; stage_index++)
   {
@@ -1921,6 +1925,15 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
     for (; i < stage->last_lookup; i++)
     {
       unsigned int lookup_index = lookups[table_index][i].index;
+      const OT::hb_ot_layout_lookup_accelerator_t &accel = proxy.accels[lookup_index];
+
+      /* Skip lookups none of whose glyphs can be in the buffer. */
+      if (!accel.may_have (c.digest))
+      {
+	(void) buffer->message (font, "skipped lookup %d because no glyph matches", lookup_index);
+	continue;
+      }
+
       if (!buffer->message (font, "start lookup %d", lookup_index)) continue;
       c.set_lookup_index (lookup_index);
       c.set_lookup_mask (lookups[table_index][i].mask);
@@ -1930,12 +1943,16 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
 
       apply_string<Proxy> (&c,
 			   proxy.table.get_lookup (lookup_index),
-			   proxy.accels[lookup_index]);
+			   accel);
       (void) buffer->message (font, "end lookup %d", lookup_index);
     }
 
     if (stage->pause_func)
+    {
       stage->pause_func (plan, font, buffer);
+      /* Pause functions may have changed the glyphs. */
+      c.update_digest ();
+    }
   }
 }
 
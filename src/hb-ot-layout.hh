@@ -211,19 +211,20 @@ enum hb_unicode_props_flags_t {
 };
 HB_MARK_AS_FLAG_T (hb_unicode_props_flags_t);
 
+/* Sets unicode_props() of @info from @props: its general category and,
+ * for non-ASCII marks, modified combining class in the high byte, as
+ * fetched by hb_unicode_funcs_t::general_categories(). */
 static inline void
-_hb_glyph_info_set_unicode_props (hb_glyph_info_t *info, hb_buffer_t *buffer)
+_hb_glyph_info_set_unicode_props (hb_glyph_info_t *info, hb_buffer_t *buffer,
+				  unsigned int props)
 {
-  hb_unicode_funcs_t *unicode = buffer->unicode;
   unsigned int u = info->codepoint;
-  unsigned int gen_cat = (unsigned int) unicode->general_category (u);
-  unsigned int props = gen_cat;
 
   if (u >= 0x80u)
   {
     buffer->scratch_flags |= HB_BUFFER_SCRATCH_FLAG_HAS_NON_ASCII;
 
-    if (unlikely (unicode->is_default_ignorable (u)))
+    if (unlikely (hb_unicode_funcs_t::is_default_ignorable (u)))
     {
       buffer->scratch_flags |= HB_BUFFER_SCRATCH_FLAG_HAS_DEFAULT_IGNORABLES;
       props |=  UPROPS_MASK_IGNORABLE;
@@ -249,16 +250,21 @@ _hb_glyph_info_set_unicode_props (hb_glyph_info_t *info, hb_buffer_t *buffer)
       }
     }
 
-    if (unlikely (HB_UNICODE_GENERAL_CATEGORY_IS_MARK (gen_cat)))
-    {
+    if (unlikely (HB_UNICODE_GENERAL_CATEGORY_IS_MARK (props & UPROPS_MASK_GEN_CAT)))
       props |= UPROPS_MASK_CONTINUATION;
-      props |= unicode->modified_combining_class (u)<<8;
-    }
   }
 
   info->unicode_props() = props;
 }
 
+static inline void
+_hb_glyph_info_set_unicode_props (hb_glyph_info_t *info, hb_buffer_t *buffer)
+{
+  uint16_t props;
+  buffer->unicode->general_categories (1, &info->codepoint, 0, &props, 0);
+  _hb_glyph_info_set_unicode_props (info, buffer, props);
+}
+
 static inline void
 _hb_glyph_info_set_general_category (hb_glyph_info_t *info,
 				     hb_unicode_general_category_t gen_cat)
@@ -480,9 +480,15 @@ hb_set_unicode_props (hb_buffer_t *buffer)
    */
   unsigned int count = buffer->len;
   hb_glyph_info_t *info = buffer->info;
+  if (unlikely (!count)) return;
+
+  /* Fetch all general categories first; then finish each from its own. */
+  buffer->unicode->general_categories (count,
+				       &info[0].codepoint, sizeof (info[0]),
+				       &info[0].unicode_props (), sizeof (info[0]));
   for (unsigned int i = 0; i < count; i++)
   {
-    _hb_glyph_info_set_unicode_props (&info[i], buffer);
+    _hb_glyph_info_set_unicode_props (&info[i], buffer, info[i].unicode_props ());
 
     /* Marks are already set as continuation by the above line.
      * Handle Emoji_Modifier and ZWJ-continuation. */
@@ -507,7 +513,7 @@ hb_set_unicode_props (hb_buffer_t *buffer)
 	  _hb_unicode_is_emoji_Extended_Pictographic (info[i + 1].codepoint))
       {
 	i++;
-	_hb_glyph_info_set_unicode_props (&info[i], buffer);
+	_hb_glyph_info_set_unicode_props (&info[i], buffer, info[i].unicode_props ());
 	_hb_glyph_info_set_continuation (&info[i]);
       }
     }
@@ -561,7 +567,8 @@ hb_insert_dotted_circle (hb_buffer_t *buffer, hb_font_t *font)
 static void
 hb_form_clusters (hb_buffer_t *buffer)
 {
-  if (!(buffer->scratch_flags & HB_BUFFER_SCRATCH_FLAG_HAS_NON_ASCII))
+  if (!(buffer->scratch_flags & HB_BUFFER_SCRATCH_FLAG_HAS_NON_ASCII) ||
+      !buffer->tracks_clusters ())
     return;
 
   if (buffer->cluster_level == HB_BUFFER_CLUSTER_LEVEL_MONOTONE_GRAPHEMES)
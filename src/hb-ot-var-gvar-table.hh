@@ -89,8 +89,11 @@ struct TupleVariationHeader
   const TupleVariationHeader &get_next (unsigned axis_count) const
   { return StructAtOffset<TupleVariationHeader> (this, get_size (axis_count)); }
 
+  /* shared_scalars, if not empty, holds calculate_peak_scalar() of each
+   * shared tuple at coords. */
   float calculate_scalar (const int *coords, unsigned int coord_count,
-			  const hb_array_t<const F2DOT14> shared_tuples) const
+			  const hb_array_t<const F2DOT14> shared_tuples,
+			  hb_array_t<const float> shared_scalars = hb_array_t<const float> ()) const
   {
     hb_array_t<const F2DOT14> peak_tuple;
 
@@ -101,17 +104,40 @@ struct TupleVariationHeader
       unsigned int index = get_index ();
       if (unlikely (index * coord_count >= shared_tuples.length))
 	return 0.f;
+      if (!has_intermediate () && index < shared_scalars.length)
+	return shared_scalars[index];
       peak_tuple = shared_tuples.sub_array (coord_count * index, coord_count);
     }
 
-    hb_array_t<const F2DOT14> start_tuple;
-    hb_array_t<const F2DOT14> end_tuple;
-    if (has_intermediate ())
+    if (!has_intermediate ())
+      return calculate_peak_scalar (coords, coord_count, peak_tuple);
+
+    hb_array_t<const F2DOT14> start_tuple = get_start_tuple (coord_count);
+    hb_array_t<const F2DOT14> end_tuple = get_end_tuple (coord_count);
+
+    float scalar = 1.f;
+    for (unsigned int i = 0; i < coord_count; i++)
     {
-      start_tuple = get_start_tuple (coord_count);
-      end_tuple = get_end_tuple (coord_count);
+      int v = coords[i];
+      int peak = peak_tuple[i];
+      if (!peak || v == peak) continue;
+
+      int start = start_tuple[i];
+      int end = end_tuple[i];
+      if (unlikely (start > peak || peak > end ||
+		    (start < 0 && end > 0 && peak))) continue;
+      if (v < start || v > end) return 0.f;
+      if (v < peak)
+      { if (peak != start) scalar *= (float) (v - start) / (peak - start); }
+      else
+      { if (peak != end) scalar *= (float) (end - v) / (end - peak); }
     }
+    return scalar;
+  }
 
+  static float calculate_peak_scalar (const int *coords, unsigned int coord_count,
+				      const hb_array_t<const F2DOT14> peak_tuple)
+  {
     float scalar = 1.f;
     for (unsigned int i = 0; i < coord_count; i++)
     {
@@ -119,21 +145,8 @@ struct TupleVariationHeader
       int peak = peak_tuple[i];
       if (!peak || v == peak) continue;
 
-      if (has_intermediate ())
-      {
-	int start = start_tuple[i];
-	int end = end_tuple[i];
-	if (unlikely (start > peak || peak > end ||
-		      (start < 0 && end > 0 && peak))) continue;
-	if (v < start || v > end) return 0.f;
-	if (v < peak)
-	{ if (peak != start) scalar *= (float) (v - start) / (peak - start); }
-	else
-	{ if (peak != end) scalar *= (float) (end - v) / (end - peak); }
-      }
-      else if (!v || v < hb_min (0, peak) || v > hb_max (0, peak)) return 0.f;
-      else
-	scalar *= (float) v / peak;
+      if (!v || v < hb_min (0, peak) || v > hb_max (0, peak)) return 0.f;
+      scalar *= (float) v / peak;
     }
     return scalar;
   }
@@ -562,9 +575,15 @@ struct gvar
       int *coords = font->coords;
       unsigned num_coords = font->num_coords;
       hb_array_t<const F2DOT14> shared_tuples = (table+table->sharedTuples).as_array (table->sharedTupleCount * table->axisCount);
+      hb_array_t<const float> shared_scalars = font->var_scalars.get (table.get (), table->sharedTupleCount,
+								      [&] (unsigned i)
+								      {
+									return TupleVariationHeader::calculate_peak_scalar (coords, num_coords,
+															    shared_tuples.sub_array (num_coords * i, num_coords));
+								      });
       do
       {
-	float scalar = iterator.current_tuple->calculate_scalar (coords, num_coords, shared_tuples);
+	float scalar = iterator.current_tuple->calculate_scalar (coords, num_coords, shared_tuples, shared_scalars);
 	if (scalar == 0.f) continue;
 	const HBUINT8 *p = iterator.get_serialized_data ();
 	unsigned int length = iterator.current_tuple->get_data_size ();
@@ -411,15 +411,14 @@ struct HVARVVAR
   float get_advance_var (hb_codepoint_t glyph, hb_font_t *font) const
   {
     uint32_t varidx = (this+advMap).map (glyph);
-    return (this+varStore).get_delta (varidx, font->coords, font->num_coords);
+    return (this+varStore).get_delta (varidx, font);
   }
 
-  float get_side_bearing_var (hb_codepoint_t glyph,
-			      const int *coords, unsigned int coord_count) const
+  float get_side_bearing_var (hb_codepoint_t glyph, hb_font_t *font) const
   {
     if (!has_side_bearing_deltas ()) return 0.f;
     uint32_t varidx = (this+lsbMap).map (glyph);
-    return (this+varStore).get_delta (varidx, coords, coord_count);
+    return (this+varStore).get_delta (varidx, font);
   }
 
   bool has_side_bearing_deltas () const { return lsbMap && rsbMap; }
@@ -73,8 +73,7 @@ struct MVAR
 				  valueRecordSize));
   }
 
-  float get_var (hb_tag_t tag,
-		 const int *coords, unsigned int coord_count) const
+  float get_var (hb_tag_t tag, hb_font_t *font) const
   {
     const VariationValueRecord *record;
     record = (VariationValueRecord *) hb_bsearch (tag,
@@ -85,7 +84,7 @@ struct MVAR
     if (!record)
       return 0.;
 
-    return (this+varStore).get_delta (record->varIdx, coords, coord_count);
+    return (this+varStore).get_delta (record->varIdx, font);
   }
 
 protected:
@@ -104,6 +104,9 @@ struct hb_set_digest_lowest_bits_t
   bool may_have (hb_codepoint_t g) const
   { return !!(mask & mask_for (g)); }
 
+  bool may_have (const hb_set_digest_lowest_bits_t &o) const
+  { return !!(mask & o.mask); }
+
   private:
 
   static mask_t mask_for (hb_codepoint_t g)
@@ -155,6 +158,12 @@ struct hb_set_digest_combiner_t
     return head.may_have (g) && tail.may_have (g);
   }
 
+  /* Whether the two sets may intersect. */
+  bool may_have (const hb_set_digest_combiner_t &o) const
+  {
+    return head.may_have (o.head) && tail.may_have (o.tail);
+  }
+
   private:
   head_t head;
   tail_t tail;
@@ -169,7 +169,7 @@ hb_set_get_user_data (hb_set_t           *set,
 hb_bool_t
 hb_set_allocation_successful (const hb_set_t  *set)
 {
-  return set->successful;
+  return !set->in_error ();
 }
 
 /**
@@ -429,22 +429,20 @@ hb_set_symmetric_difference (hb_set_t       *set,
   set->symmetric_difference (*other);
 }
 
-#ifndef HB_DISABLE_DEPRECATED
 /**
  * hb_set_invert:
  * @set: A set
  *
- * Inverts the contents of @set.
+ * Inverts the contents of @set.  The set then holds every value it did not
+ * hold before.  This is done in constant time, without allocating anything.
  *
  * Since: 0.9.10
- *
- * Deprecated: 1.6.1
  **/
 void
-hb_set_invert (hb_set_t *set HB_UNUSED)
+hb_set_invert (hb_set_t *set)
 {
+  set->invert ();
 }
-#endif
 
 /**
  * hb_set_get_population:
@@ -28,15 +28,16 @@
 #define HB_SET_HH
 
 #include "hb.hh"
-#include "hb-machinery.hh"
+#include "hb-bit-set.hh"
 
 
 /*
  * hb_set_t
  */
 
-/* TODO Keep a freelist so we can release pages that are completely zeroed.  At that
- * point maybe also use a sentinel value for "all-1" pages? */
+/* A set is a bit set, or, when inverted, the complement of one.  This keeps
+ * inverting and "everything but a few" sets O(pages); the bit set never has
+ * to fill in all the pages up to HB_SET_VALUE_INVALID. */
 
 struct hb_set_t
 {
@@ -48,194 +49,14 @@ struct hb_set_t
   // TODO Add move construtor/assign
   // TODO Add constructor for Iterator; with specialization for (sorted) vector / array?
 
-  struct page_map_t
-  {
-    int cmp (const page_map_t &o) const { return (int) o.major - (int) major; }
-    int cmp (uint32_t o_major) const { return (int) o_major - (int) major; }
-
-    uint32_t major;
-    uint32_t index;
-  };
-
-  struct page_t
-  {
-    void init0 () { v.clear (); }
-    void init1 () { v.clear (0xFF); }
-
-    constexpr unsigned len () const
-    { return ARRAY_LENGTH_CONST (v); }
-
-    bool is_empty () const
-    {
-      for (unsigned int i = 0; i < len (); i++)
-	if (v[i])
-	  return false;
-      return true;
-    }
-
-    void add (hb_codepoint_t g) { elt (g) |= mask (g); }
-    void del (hb_codepoint_t g) { elt (g) &= ~mask (g); }
-    bool get (hb_codepoint_t g) const { return elt (g) & mask (g); }
-
-    void add_range (hb_codepoint_t a, hb_codepoint_t b)
-    {
-      elt_t *la = &elt (a);
-      elt_t *lb = &elt (b);
-      if (la == lb)
-	*la |= (mask (b) << 1) - mask(a);
-      else
-      {
-	*la |= ~(mask (a) - 1);
-	la++;
-
-	memset (la, 0xff, (char *) lb - (char *) la);
-
-	*lb |= ((mask (b) << 1) - 1);
-      }
-    }
-
-    void del_range (hb_codepoint_t a, hb_codepoint_t b)
-    {
-      elt_t *la = &elt (a);
-      elt_t *lb = &elt (b);
-      if (la == lb)
-	*la &= ~((mask (b) << 1) - mask(a));
-      else
-      {
-	*la &= mask (a) - 1;
-	la++;
-
-	memset (la, 0, (char *) lb - (char *) la);
-
-	*lb &= ~((mask (b) << 1) - 1);
-      }
-    }
-
-    bool is_equal (const page_t &other) const
-    {
-      return 0 == hb_memcmp (&v, &other.v, sizeof (v));
-    }
-    bool is_subset (const page_t &larger_page) const
-    {
-      for (unsigned i = 0; i < len (); i++)
-        if (~larger_page.v[i] & v[i])
-	  return false;
-      return true;
-    }
-
-    unsigned int get_population () const
-    {
-      unsigned int pop = 0;
-      for (unsigned int i = 0; i < len (); i++)
-	pop += hb_popcount (v[i]);
-      return pop;
-    }
-
-    bool next (hb_codepoint_t *codepoint) const
-    {
-      unsigned int m = (*codepoint + 1) & MASK;
-      if (!m)
-      {
-	*codepoint = INVALID;
-	return false;
-      }
-      unsigned int i = m / ELT_BITS;
-      unsigned int j = m & ELT_MASK;
-
-      const elt_t vv = v[i] & ~((elt_t (1) << j) - 1);
-      for (const elt_t *p = &vv; i < len (); p = &v[++i])
-	if (*p)
-	{
-	  *codepoint = i * ELT_BITS + elt_get_min (*p);
-	  return true;
-	}
-
-      *codepoint = INVALID;
-      return false;
-    }
-    bool previous (hb_codepoint_t *codepoint) const
-    {
-      unsigned int m = (*codepoint - 1) & MASK;
-      if (m == MASK)
-      {
-	*codepoint = INVALID;
-	return false;
-      }
-      unsigned int i = m / ELT_BITS;
-      unsigned int j = m & ELT_MASK;
-
-      /* Fancy mask to avoid shifting by elt_t bitsize, which is undefined. */
-      const elt_t mask = j < 8 * sizeof (elt_t) - 1 ?
-			 ((elt_t (1) << (j + 1)) - 1) :
-			 (elt_t) -1;
-      const elt_t vv = v[i] & mask;
-      const elt_t *p = &vv;
-      while (true)
-      {
-	if (*p)
-	{
-	  *codepoint = i * ELT_BITS + elt_get_max (*p);
-	  return true;
-	}
-	if ((int) i <= 0) break;
-	p = &v[--i];
-      }
-
-      *codepoint = INVALID;
-      return false;
-    }
-    hb_codepoint_t get_min () const
-    {
-      for (unsigned int i = 0; i < len (); i++)
-	if (v[i])
-	  return i * ELT_BITS + elt_get_min (v[i]);
-      return INVALID;
-    }
-    hb_codepoint_t get_max () const
-    {
-      for (int i = len () - 1; i >= 0; i--)
-	if (v[i])
-	  return i * ELT_BITS + elt_get_max (v[i]);
-      return 0;
-    }
-
-    typedef unsigned long long elt_t;
-    static constexpr unsigned PAGE_BITS = 512;
-    static_assert ((PAGE_BITS & ((PAGE_BITS) - 1)) == 0, "");
-
-    static unsigned int elt_get_min (const elt_t &elt) { return hb_ctz (elt); }
-    static unsigned int elt_get_max (const elt_t &elt) { return hb_bit_storage (elt) - 1; }
-
-    typedef hb_vector_size_t<elt_t, PAGE_BITS / 8> vector_t;
-
-    static constexpr unsigned ELT_BITS = sizeof (elt_t) * 8;
-    static constexpr unsigned ELT_MASK = ELT_BITS - 1;
-    static constexpr unsigned BITS = sizeof (vector_t) * 8;
-    static constexpr unsigned MASK = BITS - 1;
-    static_assert ((unsigned) PAGE_BITS == (unsigned) BITS, "");
-
-    elt_t &elt (hb_codepoint_t g) { return v[(g & MASK) / ELT_BITS]; }
-    const elt_t& elt (hb_codepoint_t g) const { return v[(g & MASK) / ELT_BITS]; }
-    static constexpr elt_t mask (hb_codepoint_t g) { return elt_t (1) << (g & ELT_MASK); }
-
-    vector_t v;
-  };
-  static_assert (page_t::PAGE_BITS == sizeof (page_t) * 8, "");
-
   hb_object_header_t header;
-  bool successful; /* Allocations successful */
-  mutable unsigned int population;
-  mutable unsigned int last_page_lookup;
-  hb_sorted_vector_t<page_map_t> page_map;
-  hb_vector_t<page_t> pages;
+  hb_bit_set_t s;
+  bool inverted;
 
   void init_shallow ()
   {
-    successful = true;
-    population = 0;
-    last_page_lookup = 0;
-    page_map.init ();
-    pages.init ();
+    s.init ();
+    inverted = false;
   }
   void init ()
   {
@@ -244,10 +65,7 @@ struct hb_set_t
   }
   void fini_shallow ()
   {
-    population = 0;
-    last_page_lookup = 0;
-    page_map.fini ();
-    pages.fini ();
+    s.fini ();
   }
   void fini ()
   {
@@ -255,103 +73,49 @@ struct hb_set_t
     fini_shallow ();
   }
 
-  bool in_error () const { return !successful; }
-
-  bool resize (unsigned int count)
-  {
-    if (unlikely (count > pages.length && !successful)) return false;
-    if (!pages.resize (count) || !page_map.resize (count))
-    {
-      pages.resize (page_map.length);
-      successful = false;
-      return false;
-    }
-    return true;
-  }
+  bool in_error () const { return s.in_error (); }
+  void err () { s.err (); }
 
   void reset ()
   {
-    successful = true;
-    clear ();
+    s.reset ();
+    inverted = false;
   }
-
   void clear ()
   {
-    if (resize (0))
-      population = 0;
+    s.clear ();
+    if (likely (s.successful))
+      inverted = false;
   }
+  void invert ()
+  {
+    if (likely (s.successful))
+      inverted = !inverted;
+  }
+
   bool is_empty () const
   {
-    unsigned int count = pages.length;
-    for (unsigned int i = 0; i < count; i++)
-      if (!pages[i].is_empty ())
-	return false;
-    return true;
+    if (likely (!inverted))
+      return s.is_empty ();
+    hb_codepoint_t v = INVALID;
+    return !next (&v);
   }
   explicit operator bool () const { return !is_empty (); }
 
-  void dirty () { population = UINT_MAX; }
-
   void add (hb_codepoint_t g)
-  {
-    if (unlikely (!successful)) return;
-    if (unlikely (g == INVALID)) return;
-    dirty ();
-    page_t *page = page_for_insert (g); if (unlikely (!page)) return;
-    page->add (g);
-  }
+  { unlikely (inverted) ? s.del (g) : s.add (g); }
   bool add_range (hb_codepoint_t a, hb_codepoint_t b)
   {
-    if (unlikely (!successful)) return true; /* https://github.com/harfbuzz/harfbuzz/issues/657 */
+    if (likely (!inverted))
+      return s.add_range (a, b);
     if (unlikely (a > b || a == INVALID || b == INVALID)) return false;
-    dirty ();
-    unsigned int ma = get_major (a);
-    unsigned int mb = get_major (b);
-    if (ma == mb)
-    {
-      page_t *page = page_for_insert (a); if (unlikely (!page)) return false;
-      page->add_range (a, b);
-    }
-    else
-    {
-      page_t *page = page_for_insert (a); if (unlikely (!page)) return false;
-      page->add_range (a, major_start (ma + 1) - 1);
-
-      for (unsigned int m = ma + 1; m < mb; m++)
-      {
-	page = page_for_insert (major_start (m)); if (unlikely (!page)) return false;
-	page->init1 ();
-      }
-
-      page = page_for_insert (b); if (unlikely (!page)) return false;
-      page->add_range (major_start (mb), b);
-    }
+    s.del_range (a, b);
     return true;
   }
 
   template <typename T>
   void add_array (const T *array, unsigned int count, unsigned int stride=sizeof(T))
-  {
-    if (unlikely (!successful)) return;
-    if (!count) return;
-    dirty ();
-    hb_codepoint_t g = *array;
-    while (count)
-    {
-      unsigned int m = get_major (g);
-      page_t *page = page_for_insert (g); if (unlikely (!page)) return;
-      unsigned int start = major_start (m);
-      unsigned int end = major_start (m + 1);
-      do
-      {
-	page->add (g);
-
-	array = &StructAtOffsetUnaligned<T> (array, stride);
-	count--;
-      }
-      while (count && (g = *array, start <= g && g < end));
-    }
-  }
+  { unlikely (inverted) ? s.del_array (array, count, stride) : s.add_array (array, count, stride); }
   template <typename T>
   void add_array (const hb_array_t<const T>& arr) { add_array (&arr, arr.len ()); }
 
@@ -360,107 +124,18 @@ struct hb_set_t
   template <typename T>
   bool add_sorted_array (const T *array, unsigned int count, unsigned int stride=sizeof(T))
   {
-    if (unlikely (!successful)) return true; /* https://github.com/harfbuzz/harfbuzz/issues/657 */
-    if (!count) return true;
-    dirty ();
-    hb_codepoint_t g = *array;
-    hb_codepoint_t last_g = g;
-    while (count)
-    {
-      unsigned int m = get_major (g);
-      page_t *page = page_for_insert (g); if (unlikely (!page)) return false;
-      unsigned int end = major_start (m + 1);
-      do
-      {
-	/* If we try harder we can change the following comparison to <=;
-	 * Not sure if it's worth it. */
-	if (g < last_g) return false;
-	last_g = g;
-	page->add (g);
-
-	array = (const T *) ((const char *) array + stride);
-	count--;
-      }
-      while (count && (g = *array, g < end));
-    }
-    return true;
+    return unlikely (inverted) ? s.del_sorted_array (array, count, stride)
+			       : s.add_sorted_array (array, count, stride);
   }
   template <typename T>
   bool add_sorted_array (const hb_sorted_array_t<const T>& arr) { return add_sorted_array (&arr, arr.len ()); }
 
   void del (hb_codepoint_t g)
-  {
-    /* TODO perform op even if !successful. */
-    if (unlikely (!successful)) return;
-    page_t *page = page_for (g);
-    if (!page)
-      return;
-    dirty ();
-    page->del (g);
-  }
-
-  private:
-  void del_pages (int ds, int de)
-  {
-    if (ds <= de)
-    {
-      // Pre-allocate the workspace that compact() will need so we can bail on allocation failure
-      // before attempting to rewrite the page map.
-      hb_vector_t<unsigned> compact_workspace;
-      if (unlikely (!allocate_compact_workspace (compact_workspace))) return;
-
-      unsigned int write_index = 0;
-      for (unsigned int i = 0; i < page_map.length; i++)
-      {
-	int m = (int) page_map[i].major;
-	if (m < ds || de < m)
-	  page_map[write_index++] = page_map[i];
-      }
-      compact (compact_workspace, write_index);
-      resize (write_index);
-    }
-  }
-
-
-  public:
+  { unlikely (inverted) ? s.add (g) : s.del (g); }
   void del_range (hb_codepoint_t a, hb_codepoint_t b)
-  {
-    /* TODO perform op even if !successful. */
-    if (unlikely (!successful)) return;
-    if (unlikely (a > b || a == INVALID || b == INVALID)) return;
-    dirty ();
-    unsigned int ma = get_major (a);
-    unsigned int mb = get_major (b);
-    /* Delete pages from ds through de if ds <= de. */
-    int ds = (a == major_start (ma))? (int) ma: (int) (ma + 1);
-    int de = (b + 1 == major_start (mb + 1))? (int) mb: ((int) mb - 1);
-    if (ds > de || (int) ma < ds)
-    {
-      page_t *page = page_for (a);
-      if (page)
-      {
-	if (ma == mb)
-	  page->del_range (a, b);
-	else
-	  page->del_range (a, major_start (ma + 1) - 1);
-      }
-    }
-    if (de < (int) mb && ma != mb)
-    {
-      page_t *page = page_for (b);
-      if (page)
-	page->del_range (major_start (mb), b);
-    }
-    del_pages (ds, de);
-  }
+  { unlikely (inverted) ? (void) s.add_range (a, b) : s.del_range (a, b); }
 
-  bool get (hb_codepoint_t g) const
-  {
-    const page_t *page = page_for (g);
-    if (!page)
-      return false;
-    return page->get (g);
-  }
+  bool get (hb_codepoint_t g) const { return s.get (g) ^ inverted; }
 
   /* Has interface. */
   static constexpr bool SENTINEL = false;
@@ -483,412 +158,201 @@ struct hb_set_t
   }
   void set (const hb_set_t &other)
   {
-    if (unlikely (!successful)) return;
-    unsigned int count = other.pages.length;
-    if (!resize (count))
-      return;
-    population = other.population;
-    memcpy ((void *) pages, (const void *) other.pages, count * pages.item_size);
-    memcpy ((void *) page_map, (const void *) other.page_map, count * page_map.item_size);
+    s.set (other.s);
+    if (likely (s.successful))
+      inverted = other.inverted;
   }
 
   bool is_equal (const hb_set_t &other) const
   {
-    if (get_population () != other.get_population ())
-      return false;
-
-    unsigned int na = pages.length;
-    unsigned int nb = other.pages.length;
-
-    unsigned int a = 0, b = 0;
-    for (; a < na && b < nb; )
-    {
-      if (page_at (a).is_empty ()) { a++; continue; }
-      if (other.page_at (b).is_empty ()) { b++; continue; }
-      if (page_map[a].major != other.page_map[b].major ||
-	  !page_at (a).is_equal (other.page_at (b)))
-	return false;
-      a++;
-      b++;
-    }
-    for (; a < na; a++)
-      if (!page_at (a).is_empty ()) { return false; }
-    for (; b < nb; b++)
-      if (!other.page_at (b).is_empty ()) { return false; }
-
-    return true;
+    if (likely (inverted == other.inverted))
+      return s.is_equal (other.s);
+    return get_population () == other.get_population () && is_subset (other);
   }
 
   bool is_subset (const hb_set_t &larger_set) const
   {
-    /* TODO: Merge this and is_equal() into something like process(). */
-    if (unlikely(larger_set.is_empty ()))
-      return is_empty ();
+    if (likely (inverted == larger_set.inverted))
+      return inverted ? larger_set.s.is_subset (s) : s.is_subset (larger_set.s);
 
-    uint32_t spi = 0;
-    for (uint32_t lpi = 0; spi < page_map.length && lpi < larger_set.page_map.length; lpi++)
+    /* Walk our ranges.  If larger_set is not inverted, every range we check
+     * is paid for by as many of its elements, so this stays bounded by its
+     * population; otherwise, by ours. */
+    unsigned int larger_population = larger_set.get_population ();
+    hb_codepoint_t first = INVALID, last = INVALID;
+    while (next_range (&first, &last))
     {
-      uint32_t spm = page_map[spi].major;
-      uint32_t lpm = larger_set.page_map[lpi].major;
-      auto sp = page_at (spi);
-      auto lp = larger_set.page_at (lpi);
-
-      if (spm < lpm && !sp.is_empty ())
-        return false;
-
-      if (lpm < spm)
-        continue;
-
-      if (!sp.is_subset (lp))
-        return false;
-
-      spi++;
+      if (last - first >= larger_population)
+	return false;
+      for (hb_codepoint_t g = first; g <= last; g++)
+	if (!larger_set.has (g))
+	  return false;
     }
-
-    while (spi < page_map.length)
-      if (!page_at (spi++).is_empty ())
-        return false;
-
     return true;
   }
 
-  bool allocate_compact_workspace(hb_vector_t<unsigned>& workspace)
+  void union_ (const hb_set_t &other)
   {
-    if (unlikely(!workspace.resize (pages.length)))
+    if (likely (inverted == other.inverted))
     {
-      successful = false;
-      return false;
+      if (unlikely (inverted))
+	s.process (hb_bitwise_and, other.s);
+      else
+	s.process (hb_bitwise_or, other.s);
     }
-
-    return true;
-  }
-
-
-  /*
-   * workspace should be a pre-sized vector allocated to hold at exactly pages.length
-   * elements.
-   */
-  void compact (hb_vector_t<unsigned>& workspace,
-                unsigned int length)
-  {
-    assert(workspace.length == pages.length);
-    hb_vector_t<unsigned>& old_index_to_page_map_index = workspace;
-
-    hb_fill (old_index_to_page_map_index.writer(), 0xFFFFFFFF);
-    /* TODO(iter) Rewrite as dagger? */
-    for (unsigned i = 0; i < length; i++)
-      old_index_to_page_map_index[page_map[i].index] =  i;
-
-    compact_pages (old_index_to_page_map_index);
-  }
-
-  void compact_pages (const hb_vector_t<unsigned>& old_index_to_page_map_index)
-  {
-    unsigned int write_index = 0;
-    for (unsigned int i = 0; i < pages.length; i++)
+    else
     {
-      if (old_index_to_page_map_index[i] == 0xFFFFFFFF) continue;
-
-      if (write_index < i)
-	pages[write_index] = pages[i];
-
-      page_map[old_index_to_page_map_index[i]].index = write_index;
-      write_index++;
+      if (unlikely (inverted))
+	s.process (hb_bitwise_sub, other.s);
+      else
+	s.process (hb_bitwise_rsub, other.s);
     }
+    if (likely (s.successful))
+      inverted = inverted || other.inverted;
   }
-
-  template <typename Op>
-  void process (const Op& op, const hb_set_t &other)
+  void intersect (const hb_set_t &other)
   {
-    const bool passthru_left = op (1, 0);
-    const bool passthru_right = op (0, 1);
-
-    if (unlikely (!successful)) return;
-
-    dirty ();
-
-    unsigned int na = pages.length;
-    unsigned int nb = other.pages.length;
-    unsigned int next_page = na;
-
-    unsigned int count = 0, newCount = 0;
-    unsigned int a = 0, b = 0;
-    unsigned int write_index = 0;
-
-    // Pre-allocate the workspace that compact() will need so we can bail on allocation failure
-    // before attempting to rewrite the page map.
-    hb_vector_t<unsigned> compact_workspace;
-    if (!passthru_left && unlikely (!allocate_compact_workspace (compact_workspace))) return;
-
-    for (; a < na && b < nb; )
+    if (likely (inverted == other.inverted))
     {
-      if (page_map[a].major == other.page_map[b].major)
-      {
-	if (!passthru_left)
-	{
-	  // Move page_map entries that we're keeping from the left side set
-	  // to the front of the page_map vector. This isn't necessary if
-	  // passthru_left is set since no left side pages will be removed
-	  // in that case.
-	  if (write_index < a)
-	    page_map[write_index] = page_map[a];
-	  write_index++;
-	}
-
-	count++;
-	a++;
-	b++;
-      }
-      else if (page_map[a].major < other.page_map[b].major)
-      {
-	if (passthru_left)
-	  count++;
-	a++;
-      }
+      if (unlikely (inverted))
+	s.process (hb_bitwise_or, other.s);
       else
-      {
-	if (passthru_right)
-	  count++;
-	b++;
-      }
+	s.process (hb_bitwise_and, other.s);
     }
-    if (passthru_left)
-      count += na - a;
-    if (passthru_right)
-      count += nb - b;
-
-    if (!passthru_left)
-    {
-      na  = write_index;
-      next_page = write_index;
-      compact (compact_workspace, write_index);
-    }
-
-    if (!resize (count))
-      return;
-
-    newCount = count;
-
-    /* Process in-place backward. */
-    a = na;
-    b = nb;
-    for (; a && b; )
+    else
     {
-      if (page_map[a - 1].major == other.page_map[b - 1].major)
-      {
-	a--;
-	b--;
-	count--;
-	page_map[count] = page_map[a];
-	page_at (count).v = op (page_at (a).v, other.page_at (b).v);
-      }
-      else if (page_map[a - 1].major > other.page_map[b - 1].major)
-      {
-	a--;
-	if (passthru_left)
-	{
-	  count--;
-	  page_map[count] = page_map[a];
-	}
-      }
+      if (unlikely (inverted))
+	s.process (hb_bitwise_rsub, other.s);
       else
-      {
-	b--;
-	if (passthru_right)
-	{
-	  count--;
-	  page_map[count].major = other.page_map[b].major;
-	  page_map[count].index = next_page++;
-	  page_at (count).v = other.page_at (b).v;
-	}
-      }
+	s.process (hb_bitwise_sub, other.s);
     }
-    if (passthru_left)
-      while (a)
-      {
-	a--;
-	count--;
-	page_map[count] = page_map [a];
-      }
-    if (passthru_right)
-      while (b)
-      {
-	b--;
-	count--;
-	page_map[count].major = other.page_map[b].major;
-	page_map[count].index = next_page++;
-	page_at (count).v = other.page_at (b).v;
-      }
-    assert (!count);
-    if (pages.length > newCount)
-      // This resize() doesn't need to be checked because we can't get here
-      // if the set is currently in_error() and this only resizes downwards
-      // which will always succeed if the set is not in_error().
-      resize (newCount);
-  }
-
-  void union_ (const hb_set_t &other)
-  {
-    process (hb_bitwise_or, other);
-  }
-  void intersect (const hb_set_t &other)
-  {
-    process (hb_bitwise_and, other);
+    if (likely (s.successful))
+      inverted = inverted && other.inverted;
   }
   void subtract (const hb_set_t &other)
   {
-    process (hb_bitwise_sub, other);
+    if (likely (inverted == other.inverted))
+    {
+      if (unlikely (inverted))
+	s.process (hb_bitwise_rsub, other.s);
+      else
+	s.process (hb_bitwise_sub, other.s);
+    }
+    else
+    {
+      if (unlikely (inverted))
+	s.process (hb_bitwise_or, other.s);
+      else
+	s.process (hb_bitwise_and, other.s);
+    }
+    if (likely (s.successful))
+      inverted = inverted && !other.inverted;
   }
   void symmetric_difference (const hb_set_t &other)
   {
-    process (hb_bitwise_xor, other);
+    s.process (hb_bitwise_xor, other.s);
+    if (likely (s.successful))
+      inverted = inverted != other.inverted;
   }
+
   bool next (hb_codepoint_t *codepoint) const
   {
-    // TODO: this should be merged with prev() as both implementations
-    //       are very similar.
-    if (unlikely (*codepoint == INVALID)) {
-      *codepoint = get_min ();
-      return *codepoint != INVALID;
-    }
+    if (likely (!inverted))
+      return s.next (codepoint);
 
-    const auto* page_map_array = page_map.arrayZ;
-    unsigned int major = get_major (*codepoint);
-    unsigned int i = last_page_lookup;
-
-    if (unlikely (i >= page_map.length || page_map_array[i].major != major))
+    hb_codepoint_t old = *codepoint;
+    if (unlikely (old + 1 == INVALID))
     {
-      page_map.bfind (major, &i, HB_BFIND_NOT_FOUND_STORE_CLOSEST);
-      if (i >= page_map.length) {
-        *codepoint = INVALID;
-        return false;
-      }
+      *codepoint = INVALID;
+      return false;
     }
 
-    const auto* pages_array = pages.arrayZ;
-    const page_map_t &current = page_map_array[i];
-    if (likely (current.major == major))
+    /* The first codepoint after old that is not in s. */
+    hb_codepoint_t v = old;
+    s.next (&v);
+    if (old + 1 < v)
     {
-      if (pages_array[current.index].next (codepoint))
-      {
-        *codepoint += current.major * page_t::PAGE_BITS;
-        last_page_lookup = i;
-        return true;
-      }
-      i++;
+      *codepoint = old + 1;
+      return true;
     }
 
-    for (; i < page_map.length; i++)
-    {
-      const page_map_t &current = page_map.arrayZ[i];
-      hb_codepoint_t m = pages_array[current.index].get_min ();
-      if (m != INVALID)
-      {
-	*codepoint = current.major * page_t::PAGE_BITS + m;
-        last_page_lookup = i;
-	return true;
-      }
-    }
-    last_page_lookup = 0;
-    *codepoint = INVALID;
-    return false;
+    v = old;
+    s.next_range (&old, &v);
+    *codepoint = v + 1;
+    return *codepoint != INVALID;
   }
   bool previous (hb_codepoint_t *codepoint) const
   {
-    if (unlikely (*codepoint == INVALID)) {
-      *codepoint = get_max ();
-      return *codepoint != INVALID;
-    }
+    if (likely (!inverted))
+      return s.previous (codepoint);
 
-    page_map_t map = {get_major (*codepoint), 0};
-    unsigned int i;
-    page_map.bfind (map, &i, HB_BFIND_NOT_FOUND_STORE_CLOSEST);
-    if (i < page_map.length && page_map[i].major == map.major)
+    hb_codepoint_t old = *codepoint;
+    if (unlikely (old - 1 == INVALID))
     {
-      if (pages[page_map[i].index].previous (codepoint))
-      {
-	*codepoint += page_map[i].major * page_t::PAGE_BITS;
-	return true;
-      }
+      *codepoint = INVALID;
+      return false;
     }
-    i--;
-    for (; (int) i >= 0; i--)
+
+    /* The last codepoint before old that is not in s. */
+    hb_codepoint_t v = old;
+    s.previous (&v);
+    if (old - 1 > v || v == INVALID)
     {
-      hb_codepoint_t m = pages[page_map[i].index].get_max ();
-      if (m != INVALID)
-      {
-	*codepoint = page_map[i].major * page_t::PAGE_BITS + m;
-	return true;
-      }
+      *codepoint = old - 1;
+      return true;
     }
-    *codepoint = INVALID;
-    return false;
+
+    v = old;
+    s.previous_range (&v, &old);
+    *codepoint = v - 1;
+    return *codepoint != INVALID;
   }
   bool next_range (hb_codepoint_t *first, hb_codepoint_t *last) const
   {
-    hb_codepoint_t i;
+    if (likely (!inverted))
+      return s.next_range (first, last);
 
-    i = *last;
-    if (!next (&i))
+    if (!next (last))
     {
       *last = *first = INVALID;
       return false;
     }
 
-    /* TODO Speed up. */
-    *last = *first = i;
-    while (next (&i) && i == *last + 1)
-      (*last)++;
-
+    *first = *last;
+    s.next (last);
+    --*last;
     return true;
   }
   bool previous_range (hb_codepoint_t *first, hb_codepoint_t *last) const
   {
-    hb_codepoint_t i;
+    if (likely (!inverted))
+      return s.previous_range (first, last);
 
-    i = *first;
-    if (!previous (&i))
+    if (!previous (first))
     {
       *last = *first = INVALID;
       return false;
     }
 
-    /* TODO Speed up. */
-    *last = *first = i;
-    while (previous (&i) && i == *first - 1)
-      (*first)--;
-
+    *last = *first;
+    s.previous (first);
+    ++*first;
     return true;
   }
 
   unsigned int get_population () const
-  {
-    if (population != UINT_MAX)
-      return population;
-
-    unsigned int pop = 0;
-    unsigned int count = pages.length;
-    for (unsigned int i = 0; i < count; i++)
-      pop += pages[i].get_population ();
-
-    population = pop;
-    return pop;
-  }
+  { return unlikely (inverted) ? INVALID - s.get_population () : s.get_population (); }
   hb_codepoint_t get_min () const
   {
-    unsigned int count = pages.length;
-    for (unsigned int i = 0; i < count; i++)
-      if (!page_at (i).is_empty ())
-	return page_map[i].major * page_t::PAGE_BITS + page_at (i).get_min ();
-    return INVALID;
+    hb_codepoint_t v = INVALID;
+    next (&v);
+    return v;
   }
   hb_codepoint_t get_max () const
   {
-    unsigned int count = pages.length;
-    for (int i = count - 1; i >= 0; i--)
-      if (!page_at (i).is_empty ())
-	return page_map[(unsigned) i].major * page_t::PAGE_BITS + page_at (i).get_max ();
-    return INVALID;
+    hb_codepoint_t v = INVALID;
+    previous (&v);
+    return v;
   }
 
   static constexpr hb_codepoint_t INVALID = HB_SET_VALUE_INVALID;
@@ -904,8 +368,10 @@ struct hb_set_t
     {
       if (init)
       {
-	l = s->get_population () + 1;
-	__next__ ();
+	/* An inverted set can hold up to INVALID members, so don't count
+	 * the step to the first one into l, it wouldn't fit. */
+	l = s->get_population ();
+	s->next (&v);
       }
     }
 
@@ -927,45 +393,6 @@ struct hb_set_t
   iter_t iter () const { return iter_t (*this); }
   operator iter_t () const { return iter (); }
 
-  protected:
-
-  page_t *page_for_insert (hb_codepoint_t g)
-  {
-    page_map_t map = {get_major (g), pages.length};
-    unsigned int i;
-    if (!page_map.bfind (map, &i, HB_BFIND_NOT_FOUND_STORE_CLOSEST))
-    {
-      if (!resize (pages.length + 1))
-	return nullptr;
-
-      pages[map.index].init0 ();
-      memmove (page_map + i + 1,
-	       page_map + i,
-	       (page_map.length - 1 - i) * page_map.item_size);
-      page_map[i] = map;
-    }
-    return &pages[page_map[i].index];
-  }
-  page_t *page_for (hb_codepoint_t g)
-  {
-    page_map_t key = {get_major (g)};
-    const page_map_t *found = page_map.bsearch (key);
-    if (found)
-      return &pages[found->index];
-    return nullptr;
-  }
-  const page_t *page_for (hb_codepoint_t g) const
-  {
-    page_map_t key = {get_major (g)};
-    const page_map_t *found = page_map.bsearch (key);
-    if (found)
-      return &pages[found->index];
-    return nullptr;
-  }
-  page_t &page_at (unsigned int i) { return pages[page_map[i].index]; }
-  const page_t &page_at (unsigned int i) const { return pages[page_map[i].index]; }
-  unsigned int get_major (hb_codepoint_t g) const { return g / page_t::PAGE_BITS; }
-  hb_codepoint_t major_start (unsigned int major) const { return major * page_t::PAGE_BITS; }
 };
 
 
@@ -163,6 +163,129 @@ hb_shape_plan_key_t::equal (const hb_shape_plan_key_t *other)
 	 this->shaper_func == other->shaper_func;
 }
 
+/* Must agree with equal(): only hash what it compares. */
+uint32_t
+hb_shape_plan_key_t::hash () const
+{
+  uint32_t h = hb_hash ((unsigned int) props.direction);
+  h = h * 31 + hb_hash ((unsigned int) props.script);
+  h = h * 31 + hb_hash ((uintptr_t) props.language);
+  for (unsigned int i = 0; i < num_user_features; i++)
+  {
+    const hb_feature_t &feature = user_features[i];
+    h = h * 31 + hb_hash (feature.tag);
+    h = h * 31 + hb_hash (feature.value);
+    h = h * 31 + (feature.start == HB_FEATURE_GLOBAL_START &&
+		  feature.end   == HB_FEATURE_GLOBAL_END);
+  }
+#ifndef HB_NO_OT_SHAPE
+  for (unsigned int i = 0; i < ARRAY_LENGTH (ot.variations_index); i++)
+    h = h * 31 + hb_hash (ot.variations_index[i]);
+#endif
+  h = h * 31 + hb_hash ((uintptr_t) shaper_func);
+  return h;
+}
+
+
+/*
+ * hb_shape_plan_cache_t
+ */
+
+void
+hb_shape_plan_cache_t::init ()
+{
+  lock.init ();
+  entries.init ();
+  clock = 0;
+  stats.init ();
+}
+
+void
+hb_shape_plan_cache_t::fini ()
+{
+  stats.report (this, "shape-plan cache");
+  for (unsigned int i = 0; i < entries.length; i++)
+    hb_shape_plan_destroy (entries[i].shape_plan);
+  entries.fini ();
+  stats.fini ();
+  lock.fini ();
+}
+
+hb_shape_plan_t *
+hb_shape_plan_cache_t::find (hb_shape_plan_key_t *key)
+{
+  uint32_t hash = key->hash ();
+
+  hb_lock_t l (lock);
+  for (unsigned int i = 0; i < entries.length; i++)
+  {
+    entry_t &entry = entries[i];
+    if (entry.hash == hash && entry.shape_plan->key.equal (key))
+    {
+      entry.last_used = ++clock;
+      stats.hit ();
+      return hb_shape_plan_reference (entry.shape_plan);
+    }
+  }
+  stats.miss ();
+  return nullptr;
+}
+
+hb_shape_plan_t *
+hb_shape_plan_cache_t::insert (hb_shape_plan_t *shape_plan)
+{
+  uint32_t hash = shape_plan->key.hash ();
+  hb_shape_plan_t *evicted = nullptr;
+  hb_shape_plan_t *ret;
+
+  {
+    hb_lock_t l (lock);
+
+    /* Another thread might have beaten us to it. */
+    for (unsigned int i = 0; i < entries.length; i++)
+    {
+      entry_t &entry = entries[i];
+      if (entry.hash == hash && entry.shape_plan->key.equal (&shape_plan->key))
+      {
+	entry.last_used = ++clock;
+	ret = hb_shape_plan_reference (entry.shape_plan);
+	evicted = shape_plan;
+	goto done;
+      }
+    }
+
+    if (entries.length >= HB_SHAPE_PLAN_CACHE_MAX_SIZE)
+    {
+      unsigned int lru = 0;
+      for (unsigned int i = 1; i < entries.length; i++)
+	if (entries[i].last_used < entries[lru].last_used)
+	  lru = i;
+      evicted = entries[lru].shape_plan;
+      entries[lru] = entries[entries.length - 1];
+      entries.pop ();
+      DEBUG_MSG_FUNC (SHAPE_PLAN, evicted, "evicted from cache");
+    }
+
+    entry_t *entry = entries.push ();
+    if (unlikely (entries.in_error ()))
+    {
+      /* Just don't cache it. */
+      ret = shape_plan;
+      goto done;
+    }
+    entry->hash = hash;
+    entry->last_used = ++clock;
+    entry->shape_plan = shape_plan;
+    ret = hb_shape_plan_reference (shape_plan);
+    DEBUG_MSG_FUNC (SHAPE_PLAN, shape_plan, "inserted into cache");
+  }
+
+done:
+  /* Destroy outside the lock; it might be the last reference. */
+  hb_shape_plan_destroy (evicted);
+  return ret;
+}
+
 
 /*
  * hb_shape_plan_t
@@ -526,9 +649,6 @@ hb_shape_plan_create_cached2 (hb_face_t                     *face,
 		  num_user_features,
 		  shaper_list);
 
-retry:
-  hb_face_t::plan_node_t *cached_plan_nodes = face->shape_plans;
-
   bool dont_cache = hb_object_is_inert (face);
 
   if (likely (!dont_cache))
@@ -544,12 +664,12 @@ retry:
 		   shaper_list))
       return hb_shape_plan_get_empty ();
 
-    for (hb_face_t::plan_node_t *node = cached_plan_nodes; node; node = node->next)
-      if (node->shape_plan->key.equal (&key))
-      {
-	DEBUG_MSG_FUNC (SHAPE_PLAN, node->shape_plan, "fulfilled from cache");
-	return hb_shape_plan_reference (node->shape_plan);
-      }
+    hb_shape_plan_t *cached = face->shape_plans.find (&key);
+    if (cached)
+    {
+      DEBUG_MSG_FUNC (SHAPE_PLAN, cached, "fulfilled from cache");
+      return cached;
+    }
   }
 
   hb_shape_plan_t *shape_plan = hb_shape_plan_create2 (face, props,
@@ -557,23 +677,8 @@ retry:
 						       coords, num_coords,
 						       shaper_list);
 
-  if (unlikely (dont_cache))
-    return shape_plan;
-
-  hb_face_t::plan_node_t *node = (hb_face_t::plan_node_t *) hb_calloc (1, sizeof (hb_face_t::plan_node_t));
-  if (unlikely (!node))
+  if (unlikely (dont_cache || hb_object_is_inert (shape_plan)))
     return shape_plan;
 
-  node->shape_plan = shape_plan;
-  node->next = cached_plan_nodes;
-
-  if (unlikely (!face->shape_plans.cmpexch (cached_plan_nodes, node)))
-  {
-    hb_shape_plan_destroy (shape_plan);
-    hb_free (node);
-    goto retry;
-  }
-  DEBUG_MSG_FUNC (SHAPE_PLAN, shape_plan, "inserted into cache");
-
-  return hb_shape_plan_reference (shape_plan);
+  return face->shape_plans.insert (shape_plan);
 }
@@ -28,6 +28,7 @@
 #define HB_SHAPE_PLAN_HH
 
 #include "hb.hh"
+#include "hb-cache.hh"
 #include "hb-shaper.hh"
 #include "hb-ot-shape.hh"
 
@@ -60,6 +61,8 @@ struct hb_shape_plan_key_t
   HB_INTERNAL bool user_features_match (const hb_shape_plan_key_t *other);
 
   HB_INTERNAL bool equal (const hb_shape_plan_key_t *other);
+
+  HB_INTERNAL uint32_t hash () const;
 };
 
 struct hb_shape_plan_t
@@ -73,4 +76,43 @@ struct hb_shape_plan_t
 };
 
 
+
+/*
+ * hb_shape_plan_cache_t
+ *
+ * The per-face cache used by hb_shape_plan_create_cached2().  Lookups
+ * compare precomputed key hashes before full keys; once the cache
+ * holds HB_SHAPE_PLAN_CACHE_MAX_SIZE plans, inserting a new one evicts
+ * the least-recently used.  The cache owns one reference to each plan,
+ * so evicted plans stay alive for as long as callers hold them.
+ */
+
+#ifndef HB_SHAPE_PLAN_CACHE_MAX_SIZE
+#define HB_SHAPE_PLAN_CACHE_MAX_SIZE 64
+#endif
+
+struct hb_shape_plan_cache_t
+{
+  HB_INTERNAL void init ();
+  HB_INTERNAL void fini ();
+
+  /* Both return a new reference. */
+  HB_INTERNAL hb_shape_plan_t *find (hb_shape_plan_key_t *key);
+  HB_INTERNAL hb_shape_plan_t *insert (hb_shape_plan_t *shape_plan);
+
+  private:
+  struct entry_t
+  {
+    uint32_t hash;
+    unsigned int last_used;
+    hb_shape_plan_t *shape_plan;
+  };
+
+  hb_mutex_t lock;
+  hb_vector_t<entry_t> entries;
+  unsigned int clock;
+  hb_cache_stats_t stats;
+};
+
+
 #endif /* HB_SHAPE_PLAN_HH */
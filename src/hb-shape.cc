@@ -33,6 +33,8 @@
 #include "hb-buffer.hh"
 #include "hb-font.hh"
 #include "hb-machinery.hh"
+#include "hb-cache.hh"
+#include "hb-map.hh"
 
 
 /**
@@ -166,3 +168,594 @@ hb_shape (hb_font_t           *font,
 {
   hb_shape_full (font, buffer, features, num_features, nullptr);
 }
+
+
+#ifdef HB_EXPERIMENTAL_API
+
+/* Shapes each run into a scratch buffer and appends the result to
+ * buffer.  Consecutive runs with the same segment properties share one
+ * shape plan, and the scratch buffer keeps its allocations from run to
+ * run. */
+template <typename T>
+static hb_bool_t
+_hb_shape_batch (hb_font_t            *font,
+		 hb_buffer_t          *buffer,
+		 const T              *text,
+		 int                   text_length,
+		 hb_shape_batch_run_t *runs,
+		 unsigned int          run_count,
+		 const hb_feature_t   *features,
+		 unsigned int          num_features,
+		 void (*add) (hb_buffer_t *, const T *, int, unsigned int, int))
+{
+  if (unlikely (hb_object_is_immutable (buffer)))
+    return false;
+  hb_buffer_clear_contents (buffer);
+  buffer->content_type = HB_BUFFER_CONTENT_TYPE_GLYPHS;
+
+  if (text_length == -1)
+  {
+    text_length = 0;
+    while (text[text_length])
+      text_length++;
+  }
+
+  hb_buffer_t *scratch = hb_buffer_create ();
+  hb_buffer_set_unicode_funcs (scratch, buffer->unicode);
+  hb_buffer_set_cluster_level (scratch, buffer->cluster_level);
+  hb_buffer_set_replacement_codepoint (scratch, buffer->replacement);
+  hb_buffer_set_invisible_glyph (scratch, buffer->invisible);
+
+  hb_shape_plan_t *shape_plan = nullptr;
+  bool ret = scratch->successful;
+  for (unsigned int i = 0; ret && i < run_count; i++)
+  {
+    hb_shape_batch_run_t &run = runs[i];
+    run.glyph_start = buffer->len;
+    run.glyph_length = 0;
+
+    if (unlikely (run.offset > (unsigned) text_length ||
+		  run.length > (unsigned) text_length - run.offset))
+    {
+      ret = false;
+      break;
+    }
+
+    /* BOT and EOT apply to the edges of the whole text only. */
+    hb_buffer_flags_t flags = buffer->flags & ~(HB_BUFFER_FLAG_BOT | HB_BUFFER_FLAG_EOT);
+    if (run.offset == 0)
+      flags |= buffer->flags & HB_BUFFER_FLAG_BOT;
+    if (run.offset + run.length == (unsigned) text_length)
+      flags |= buffer->flags & HB_BUFFER_FLAG_EOT;
+
+    hb_buffer_clear_contents (scratch);
+    hb_buffer_set_flags (scratch, flags);
+    hb_buffer_set_segment_properties (scratch, &run.props);
+    add (scratch, text, text_length, run.offset, run.length);
+    hb_buffer_guess_segment_properties (scratch);
+
+    if (!shape_plan || !hb_segment_properties_equal (&scratch->props, &shape_plan->key.props))
+    {
+      hb_shape_plan_destroy (shape_plan);
+      shape_plan = hb_shape_plan_create_cached2 (font->face, &scratch->props,
+						 features, num_features,
+						 font->coords, font->num_coords,
+						 nullptr);
+    }
+
+    ret = hb_shape_plan_execute (shape_plan, font, scratch, features, num_features);
+    if (unlikely (!ret))
+      break;
+
+    hb_buffer_append (buffer, scratch, 0, scratch->len);
+    ret = buffer->successful;
+    run.glyph_length = buffer->len - run.glyph_start;
+  }
+  hb_shape_plan_destroy (shape_plan);
+  hb_buffer_destroy (scratch);
+
+  return ret;
+}
+
+/**
+ * hb_shape_batch_utf8:
+ * @font: an #hb_font_t to use for shaping
+ * @buffer: an #hb_buffer_t to hold the output
+ * @text: (array length=text_length): the text, in UTF-8
+ * @text_length: the length of @text, or -1 if it is %NULL terminated
+ * @runs: (array length=run_count) (inout): the runs of @text to shape
+ * @run_count: the length of @runs array
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or %NULL
+ * @num_features: the length of @features array
+ *
+ * Shapes many runs of @text, such as words, in one go, as if each were
+ * added to @buffer with hb_buffer_add_utf8() and shaped with hb_shape().
+ * Glyphs of all runs are stored in @buffer one run after the other,
+ * and @runs receive where theirs are.  Clusters, and the ranges of
+ * @features, are offsets into @text.
+ *
+ * The flags, cluster level, Unicode functions, and replacement and
+ * invisible code points of @buffer apply to all runs; of its flags,
+ * #HB_BUFFER_FLAG_BOT and #HB_BUFFER_FLAG_EOT only to runs at the
+ * start and end of @text.  Its contents are replaced.
+ *
+ * This is faster than shaping the runs one by one, as consecutive
+ * runs with the same segment properties share one shape plan, and no
+ * buffer needs to be set up for each.
+ *
+ * Return value: false if shaping failed, or a run is out of @text;
+ *    @buffer then holds the glyphs of the runs before it.
+ *
+ * Since: EXPERIMENTAL
+ **/
+hb_bool_t
+hb_shape_batch_utf8 (hb_font_t            *font,
+		     hb_buffer_t          *buffer,
+		     const char           *text,
+		     int                   text_length,
+		     hb_shape_batch_run_t *runs,
+		     unsigned int          run_count,
+		     const hb_feature_t   *features,
+		     unsigned int          num_features)
+{
+  return _hb_shape_batch (font, buffer, text, text_length,
+			  runs, run_count, features, num_features,
+			  hb_buffer_add_utf8);
+}
+
+/**
+ * hb_shape_batch_utf16:
+ * @font: an #hb_font_t to use for shaping
+ * @buffer: an #hb_buffer_t to hold the output
+ * @text: (array length=text_length): the text, in UTF-16
+ * @text_length: the length of @text, or -1 if it is %NULL terminated
+ * @runs: (array length=run_count) (inout): the runs of @text to shape
+ * @run_count: the length of @runs array
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or %NULL
+ * @num_features: the length of @features array
+ *
+ * Like hb_shape_batch_utf8(), but for UTF-16 text; see there.
+ *
+ * Return value: false if shaping failed, or a run is out of @text.
+ *
+ * Since: EXPERIMENTAL
+ **/
+hb_bool_t
+hb_shape_batch_utf16 (hb_font_t            *font,
+		      hb_buffer_t          *buffer,
+		      const uint16_t       *text,
+		      int                   text_length,
+		      hb_shape_batch_run_t *runs,
+		      unsigned int          run_count,
+		      const hb_feature_t   *features,
+		      unsigned int          num_features)
+{
+  return _hb_shape_batch (font, buffer, text, text_length,
+			  runs, run_count, features, num_features,
+			  hb_buffer_add_utf16);
+}
+
+/**
+ * hb_shape_batch_utf32:
+ * @font: an #hb_font_t to use for shaping
+ * @buffer: an #hb_buffer_t to hold the output
+ * @text: (array length=text_length): the text, in UTF-32
+ * @text_length: the length of @text, or -1 if it is %NULL terminated
+ * @runs: (array length=run_count) (inout): the runs of @text to shape
+ * @run_count: the length of @runs array
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or %NULL
+ * @num_features: the length of @features array
+ *
+ * Like hb_shape_batch_utf8(), but for UTF-32 text; see there.
+ *
+ * Return value: false if shaping failed, or a run is out of @text.
+ *
+ * Since: EXPERIMENTAL
+ **/
+hb_bool_t
+hb_shape_batch_utf32 (hb_font_t            *font,
+		      hb_buffer_t          *buffer,
+		      const uint32_t       *text,
+		      int                   text_length,
+		      hb_shape_batch_run_t *runs,
+		      unsigned int          run_count,
+		      const hb_feature_t   *features,
+		      unsigned int          num_features)
+{
+  return _hb_shape_batch (font, buffer, text, text_length,
+			  runs, run_count, features, num_features,
+			  hb_buffer_add_utf32);
+}
+
+
+
+/*
+ * hb_shape_cache_t
+ */
+
+/* Results of shaping short runs with one font, keyed by everything else
+ * shaping them depends on: the text and its context, the segment
+ * properties, the buffer settings and the features.  Entries are all
+ * dropped at once when the cache fills up, or when it is used with
+ * another font or the font changes. */
+struct hb_shape_cache_t
+{
+  hb_object_header_t header;
+
+  static constexpr unsigned MAX_LENGTH = 64; /* Longest run cached. */
+  static constexpr unsigned MAX_ENTRIES = 4096;
+
+  struct entry_t
+  {
+    unsigned int key_length;
+    unsigned int glyph_count;
+
+    uint32_t *key () { return reinterpret_cast<uint32_t *> (this + 1); }
+    hb_glyph_info_t *infos () { return reinterpret_cast<hb_glyph_info_t *> (key () + key_length); }
+    hb_glyph_position_t *positions () { return reinterpret_cast<hb_glyph_position_t *> (infos () + glyph_count); }
+  };
+
+  hb_font_t *font;
+  unsigned int serial;
+  hb_hashmap_t<unsigned int, entry_t *, (unsigned int) -1, nullptr> entries; /* Keyed by hash of key. */
+  hb_vector_t<uint32_t> key; /* Scratch. */
+  hb_cache_stats_t stats;
+
+  void init ()
+  {
+    font = nullptr;
+    serial = 0;
+    entries.init_shallow ();
+    key.init ();
+    stats.init ();
+  }
+  void fini ()
+  {
+    stats.report (this, "shape cache");
+    clear ();
+    hb_font_destroy (font);
+    entries.fini_shallow ();
+    key.fini ();
+    stats.fini ();
+  }
+
+  void clear ()
+  {
+    for (entry_t *entry : entries.values ())
+      hb_free (entry);
+    entries.clear ();
+  }
+
+  void bind (hb_font_t *font_)
+  {
+    if (likely (font == font_ && serial == font_->serial))
+      return;
+    clear ();
+    hb_font_destroy (font);
+    font = hb_font_reference (font_);
+    serial = font_->serial;
+  }
+
+  void push (const void *p)
+  {
+    uintptr_t v = (uintptr_t) p;
+    key.push (v & 0xFFFFFFFFu);
+    key.push ((uint64_t) v >> 32);
+  }
+
+  /* Shapers only look at the context to find the nearest character that
+   * is not transparent for joining; include up to that. */
+  void push_context (const hb_buffer_t *buffer, unsigned int side)
+  {
+    unsigned int length = 0;
+    while (length < buffer->context_len[side])
+    {
+      hb_codepoint_t u = buffer->context[side][length++];
+      hb_unicode_general_category_t gen_cat = buffer->unicode->general_category (u);
+      if (gen_cat != HB_UNICODE_GENERAL_CATEGORY_NON_SPACING_MARK &&
+	  gen_cat != HB_UNICODE_GENERAL_CATEGORY_ENCLOSING_MARK &&
+	  gen_cat != HB_UNICODE_GENERAL_CATEGORY_FORMAT)
+	break;
+    }
+    key.push (length);
+    for (unsigned int i = 0; i < length; i++)
+      key.push (buffer->context[side][i]);
+  }
+
+  /* Fills key for buffer; returns the hash of it. */
+  unsigned int make_key (const hb_buffer_t *buffer,
+			 const hb_feature_t *features,
+			 unsigned int num_features)
+  {
+    key.resize (0);
+    key.push (buffer->props.direction);
+    key.push (buffer->props.script);
+    push (buffer->props.language);
+    push (buffer->unicode);
+    key.push (buffer->flags);
+    key.push (buffer->cluster_level);
+    key.push (buffer->replacement);
+    key.push (buffer->invisible);
+    key.push (num_features);
+    for (unsigned int i = 0; i < num_features; i++)
+    {
+      key.push (features[i].tag);
+      key.push (features[i].value);
+    }
+    push_context (buffer, 0);
+    push_context (buffer, 1);
+    key.push (buffer->len);
+    unsigned int base = buffer->info[0].cluster;
+    for (unsigned int i = 0; i < buffer->len; i++)
+    {
+      key.push (buffer->info[i].codepoint);
+      key.push (buffer->info[i].cluster - base);
+    }
+
+    uint32_t h = 2166136261u;
+    for (uint32_t v : key)
+      h = (h ^ v) * 16777619u;
+    return h == (unsigned int) -1 ? 0 : h;
+  }
+
+  static bool cacheable (hb_buffer_t *buffer,
+			 const hb_feature_t *features,
+			 unsigned int num_features)
+  {
+    if (buffer->content_type != HB_BUFFER_CONTENT_TYPE_UNICODE ||
+	!buffer->len || buffer->len > MAX_LENGTH ||
+	buffer->messaging () ||
+	!buffer->successful)
+      return false;
+    /* Feature ranges are in terms of clusters, which the key only has
+     * relative to the first. */
+    for (unsigned int i = 0; i < num_features; i++)
+      if (features[i].start != HB_FEATURE_GLOBAL_START ||
+	  features[i].end != HB_FEATURE_GLOBAL_END)
+	return false;
+    return true;
+  }
+
+  bool shape (hb_font_t *font_,
+	      hb_buffer_t *buffer,
+	      const hb_feature_t *features,
+	      unsigned int num_features)
+  {
+    if (!cacheable (buffer, features, num_features))
+      return hb_shape_full (font_, buffer, features, num_features, nullptr);
+
+    bind (font_);
+    unsigned int hash = make_key (buffer, features, num_features);
+    if (unlikely (key.in_error ()))
+      return hb_shape_full (font_, buffer, features, num_features, nullptr);
+
+    unsigned int base = buffer->info[0].cluster;
+    entry_t *entry = entries.get (hash);
+    if (entry &&
+	entry->key_length == key.length &&
+	!hb_memcmp (entry->key (), key.arrayZ, key.length * sizeof (key[0])))
+    {
+      stats.hit ();
+      unsigned int count = entry->glyph_count;
+      if (unlikely (!buffer->ensure (count)))
+	return false;
+      buffer->len = count;
+      memcpy (buffer->info, entry->infos (), count * sizeof (buffer->info[0]));
+      buffer->clear_positions ();
+      memcpy (buffer->pos, entry->positions (), count * sizeof (buffer->pos[0]));
+      for (unsigned int i = 0; i < count; i++)
+	buffer->info[i].cluster += base;
+      buffer->content_type = HB_BUFFER_CONTENT_TYPE_GLYPHS;
+      return true;
+    }
+    stats.miss ();
+
+    if (unlikely (!hb_shape_full (font_, buffer, features, num_features, nullptr)))
+      return false;
+    if (unlikely (!buffer->successful))
+      return true;
+
+    unsigned int count = buffer->len;
+    entry = (entry_t *) hb_malloc (sizeof (entry_t) +
+				   key.length * sizeof (key[0]) +
+				   count * (sizeof (hb_glyph_info_t) + sizeof (hb_glyph_position_t)));
+    if (unlikely (!entry))
+      return true;
+    entry->key_length = key.length;
+    entry->glyph_count = count;
+    memcpy (entry->key (), key.arrayZ, key.length * sizeof (key[0]));
+    memcpy (entry->infos (), buffer->info, count * sizeof (buffer->info[0]));
+    memcpy (entry->positions (), buffer->pos, count * sizeof (buffer->pos[0]));
+    for (unsigned int i = 0; i < count; i++)
+      entry->infos ()[i].cluster -= base;
+
+    if (entries.get_population () >= MAX_ENTRIES)
+      clear ();
+    hb_free (entries.get (hash));
+    if (unlikely (!entries.set (hash, entry)))
+      hb_free (entry);
+    return true;
+  }
+};
+
+
+/**
+ * hb_shape_cache_create:
+ *
+ * Creates a new, empty, shaping result cache, to be used with
+ * hb_shape_cached().
+ *
+ * Return value: (transfer full): The new shaping result cache
+ *
+ * Since: EXPERIMENTAL
+ **/
+hb_shape_cache_t *
+hb_shape_cache_create ()
+{
+  hb_shape_cache_t *cache;
+
+  if (!(cache = hb_object_create<hb_shape_cache_t> ()))
+    return hb_shape_cache_get_empty ();
+
+  cache->init ();
+
+  return cache;
+}
+
+/**
+ * hb_shape_cache_get_empty:
+ *
+ * Fetches the singleton empty shaping result cache, which caches
+ * nothing.
+ *
+ * Return value: (transfer full): The empty shaping result cache
+ *
+ * Since: EXPERIMENTAL
+ **/
+hb_shape_cache_t *
+hb_shape_cache_get_empty ()
+{
+  return const_cast<hb_shape_cache_t *> (&Null (hb_shape_cache_t));
+}
+
+/**
+ * hb_shape_cache_reference: (skip)
+ * @cache: A shaping result cache
+ *
+ * Increases the reference count on the given shaping result cache.
+ *
+ * Return value: (transfer full): @cache
+ *
+ * Since: EXPERIMENTAL
+ **/
+hb_shape_cache_t *
+hb_shape_cache_reference (hb_shape_cache_t *cache)
+{
+  return hb_object_reference (cache);
+}
+
+/**
+ * hb_shape_cache_destroy: (skip)
+ * @cache: A shaping result cache
+ *
+ * Decreases the reference count on the given shaping result cache.
+ * When the reference count reaches zero, the cache is destroyed,
+ * freeing all memory.
+ *
+ * Since: EXPERIMENTAL
+ **/
+void
+hb_shape_cache_destroy (hb_shape_cache_t *cache)
+{
+  if (!hb_object_destroy (cache)) return;
+
+  cache->fini ();
+
+  hb_free (cache);
+}
+
+/**
+ * hb_shape_cache_set_user_data: (skip)
+ * @cache: A shaping result cache
+ * @key: The user-data key to set
+ * @data: A pointer to the user data
+ * @destroy: (nullable): A callback to call when @data is not needed anymore
+ * @replace: Whether to replace an existing data with the same key
+ *
+ * Attaches a user-data key/data pair to the given shaping result cache.
+ *
+ * Return value: %true if success, %false otherwise.
+ *
+ * Since: EXPERIMENTAL
+ **/
+hb_bool_t
+hb_shape_cache_set_user_data (hb_shape_cache_t   *cache,
+			      hb_user_data_key_t *key,
+			      void *              data,
+			      hb_destroy_func_t   destroy,
+			      hb_bool_t           replace)
+{
+  return hb_object_set_user_data (cache, key, data, destroy, replace);
+}
+
+/**
+ * hb_shape_cache_get_user_data: (skip)
+ * @cache: A shaping result cache
+ * @key: The user-data key to query
+ *
+ * Fetches the user data associated with the specified key,
+ * attached to the specified shaping result cache.
+ *
+ * Return value: (transfer none): A pointer to the user data
+ *
+ * Since: EXPERIMENTAL
+ **/
+void *
+hb_shape_cache_get_user_data (hb_shape_cache_t   *cache,
+			      hb_user_data_key_t *key)
+{
+  return hb_object_get_user_data (cache, key);
+}
+
+/**
+ * hb_shape_cache_clear:
+ * @cache: A shaping result cache
+ *
+ * Drops all results stored in @cache.
+ *
+ * Since: EXPERIMENTAL
+ **/
+void
+hb_shape_cache_clear (hb_shape_cache_t *cache)
+{
+  if (unlikely (hb_object_is_immutable (cache)))
+    return;
+
+  cache->clear ();
+}
+
+/**
+ * hb_shape_cached:
+ * @cache: A shaping result cache
+ * @font: an #hb_font_t to use for shaping
+ * @buffer: an #hb_buffer_t to shape
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or %NULL
+ * @num_features: the length of @features array
+ *
+ * Like hb_shape(), but if @buffer was shaped with @cache before with
+ * the same text, context, segment properties, flags, cluster level,
+ * Unicode functions, replacement and invisible code points, and
+ * @features, copies the result stored then instead of shaping it again.
+ * Meant for shaping text one word at a time, where the same words come
+ * up over and over.
+ *
+ * Only buffers of up to 64 characters, and with no @features applying
+ * to a range, are stored.  A cache is meant to be used with one font
+ * at a time: switching to another font, or changing @font, drops all
+ * results.  Changes to the parent of @font are not noticed; call
+ * hb_shape_cache_clear() after them.
+ *
+ * A cache must not be used from multiple threads at the same time.
+ *
+ * Return value: false if all shapers failed, true otherwise
+ *
+ * Since: EXPERIMENTAL
+ **/
+hb_bool_t
+hb_shape_cached (hb_shape_cache_t   *cache,
+		 hb_font_t          *font,
+		 hb_buffer_t        *buffer,
+		 const hb_feature_t *features,
+		 unsigned int        num_features)
+{
+  if (unlikely (hb_object_is_immutable (cache)))
+    return hb_shape_full (font, buffer, features, num_features, nullptr);
+
+  return cache->shape (font, buffer, features, num_features);
+}
+
+#endif
@@ -56,6 +56,104 @@ hb_shape_full (hb_font_t          *font,
 HB_EXTERN const char **
 hb_shape_list_shapers (void);
 
+#ifdef HB_EXPERIMENTAL_API
+/**
+ * hb_shape_batch_run_t:
+ * @offset: the start of the run in the text, in code units.
+ * @length: the length of the run, in code units.
+ * @props: the segment properties of the run; unset ones are guessed
+ *    as by hb_buffer_guess_segment_properties().
+ * @glyph_start: (out): the index of the first glyph of the run in the
+ *    output buffer.
+ * @glyph_length: (out): the number of glyphs of the run.
+ *
+ * A run of text to shape with hb_shape_batch_utf8() and friends.
+ *
+ * Since: EXPERIMENTAL
+ **/
+typedef struct hb_shape_batch_run_t {
+  unsigned int            offset;
+  unsigned int            length;
+  hb_segment_properties_t props;
+
+  unsigned int            glyph_start;
+  unsigned int            glyph_length;
+} hb_shape_batch_run_t;
+
+HB_EXTERN hb_bool_t
+hb_shape_batch_utf8 (hb_font_t            *font,
+		     hb_buffer_t          *buffer,
+		     const char           *text,
+		     int                   text_length,
+		     hb_shape_batch_run_t *runs,
+		     unsigned int          run_count,
+		     const hb_feature_t   *features,
+		     unsigned int          num_features);
+
+HB_EXTERN hb_bool_t
+hb_shape_batch_utf16 (hb_font_t            *font,
+		      hb_buffer_t          *buffer,
+		      const uint16_t       *text,
+		      int                   text_length,
+		      hb_shape_batch_run_t *runs,
+		      unsigned int          run_count,
+		      const hb_feature_t   *features,
+		      unsigned int          num_features);
+
+HB_EXTERN hb_bool_t
+hb_shape_batch_utf32 (hb_font_t            *font,
+		      hb_buffer_t          *buffer,
+		      const uint32_t       *text,
+		      int                   text_length,
+		      hb_shape_batch_run_t *runs,
+		      unsigned int          run_count,
+		      const hb_feature_t   *features,
+		      unsigned int          num_features);
+
+/**
+ * hb_shape_cache_t:
+ *
+ * Data type for caching the results of shaping short runs of text,
+ * such as words, with one font.
+ *
+ * Since: EXPERIMENTAL
+ **/
+typedef struct hb_shape_cache_t hb_shape_cache_t;
+
+HB_EXTERN hb_shape_cache_t *
+hb_shape_cache_create (void);
+
+HB_EXTERN hb_shape_cache_t *
+hb_shape_cache_get_empty (void);
+
+HB_EXTERN hb_shape_cache_t *
+hb_shape_cache_reference (hb_shape_cache_t *cache);
+
+HB_EXTERN void
+hb_shape_cache_destroy (hb_shape_cache_t *cache);
+
+HB_EXTERN hb_bool_t
+hb_shape_cache_set_user_data (hb_shape_cache_t   *cache,
+			      hb_user_data_key_t *key,
+			      void *              data,
+			      hb_destroy_func_t   destroy,
+			      hb_bool_t           replace);
+
+HB_EXTERN void *
+hb_shape_cache_get_user_data (hb_shape_cache_t   *cache,
+			      hb_user_data_key_t *key);
+
+HB_EXTERN void
+hb_shape_cache_clear (hb_shape_cache_t *cache);
+
+HB_EXTERN hb_bool_t
+hb_shape_cached (hb_shape_cache_t   *cache,
+		 hb_font_t          *font,
+		 hb_buffer_t        *buffer,
+		 const hb_feature_t *features,
+		 unsigned int        num_features);
+#endif
+
 
 HB_END_DECLS
 
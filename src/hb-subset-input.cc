@@ -211,6 +211,11 @@ hb_subset_input_destroy (hb_subset_input_t *subset_input)
   hb_set_destroy (subset_input->drop_tables);
   hb_set_destroy (subset_input->layout_features);
 
+#ifdef HB_EXPERIMENTAL_API
+  if (subset_input->parallel_for_destroy)
+    subset_input->parallel_for_destroy (subset_input->parallel_for_user_data);
+#endif
+
   hb_free (subset_input);
 }
 
@@ -378,3 +383,33 @@ hb_subset_input_get_no_prune_unicode_ranges (hb_subset_input_t *subset_input)
   return subset_input->no_prune_unicode_ranges;
 }
 
+#ifdef HB_EXPERIMENTAL_API
+/**
+ * hb_subset_input_set_parallel_for_func:
+ * @subset_input: a subset_input.
+ * @func: (nullable): function that runs the per-table tasks.
+ * @user_data: data to pass to @func.
+ * @destroy: (nullable): function to call when @user_data is not needed
+ * anymore.
+ *
+ * Once the subset plan is made, most tables are subset independently of
+ * each other.  If @func is set, hb_subset() hands one task per table to
+ * it, which may run them concurrently, for example on a thread pool.
+ * The resulting face is the same as when subsetting serially.
+ *
+ * Since: EXPERIMENTAL
+ **/
+void
+hb_subset_input_set_parallel_for_func (hb_subset_input_t             *subset_input,
+				       hb_subset_parallel_for_func_t  func,
+				       void                          *user_data,
+				       hb_destroy_func_t              destroy)
+{
+  if (subset_input->parallel_for_destroy)
+    subset_input->parallel_for_destroy (subset_input->parallel_for_user_data);
+
+  subset_input->parallel_for_func = func;
+  subset_input->parallel_for_user_data = user_data;
+  subset_input->parallel_for_destroy = destroy;
+}
+#endif
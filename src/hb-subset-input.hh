@@ -54,6 +54,12 @@ struct hb_subset_input_t
   hb_bool_t notdef_outline;
   hb_bool_t no_prune_unicode_ranges;
   hb_bool_t retain_all_layout_features;
+
+#ifdef HB_EXPERIMENTAL_API
+  hb_subset_parallel_for_func_t parallel_for_func;
+  void *parallel_for_user_data;
+  hb_destroy_func_t parallel_for_destroy;
+#endif
   /* TODO
    *
    * features
@@ -41,6 +41,176 @@
 
 
 typedef hb_hashmap_t<unsigned, hb_set_t *, (unsigned)-1, nullptr> script_langsys_map;
+
+/*
+ * Face-level data the plan needs that does not depend on the subset input.
+ * It is attached to the source face the first time that face is subset, and
+ * shared by all later plans for it.  The cmap, GSUB/GPOS, CFF and COLR
+ * accelerators the plan uses already live in face->table.
+ */
+
+/* cmap mapping sorted by glyph, to look up the codepoints of a glyph. */
+struct hb_subset_cmap_reverse_map_t
+{
+  struct item_t
+  {
+    static int cmp (const void *pa, const void *pb)
+    {
+      const item_t *a = (const item_t *) pa;
+      const item_t *b = (const item_t *) pb;
+      if (a->gid != b->gid) return a->gid < b->gid ? -1 : 1;
+      if (a->unicode != b->unicode) return a->unicode < b->unicode ? -1 : 1;
+      return 0;
+    }
+
+    hb_codepoint_t gid;
+    hb_codepoint_t unicode;
+  };
+
+  void init (hb_face_t *face)
+  {
+    items.init ();
+
+    hb_map_t mapping;
+    face->table.cmap->collect_mapping (hb_set_get_empty (), &mapping);
+    if (unlikely (!items.alloc (mapping.get_population ()))) return;
+    for (auto _ : mapping.iter ())
+      items.push (item_t {_.second, _.first});
+    items.qsort ();
+  }
+  void fini () { items.fini (); }
+
+  bool in_error () const { return items.in_error (); }
+
+  hb_array_t<const item_t> unicodes_for (hb_codepoint_t gid) const
+  {
+    unsigned lo = 0, hi = items.length;
+    while (lo < hi)
+    {
+      unsigned mid = (lo + hi) / 2;
+      if (items[mid].gid < gid) lo = mid + 1;
+      else hi = mid;
+    }
+    unsigned end = lo;
+    while (end < items.length && items[end].gid == gid)
+      end++;
+    return items.as_array ().sub_array (lo, end - lo);
+  }
+
+  hb_vector_t<item_t> items;
+};
+
+/* Components of glyf composites, in compressed sparse row form: the
+ * components of gid are components[offsets[gid]] up to
+ * components[offsets[gid + 1]]. */
+struct hb_subset_glyf_components_t
+{
+  void init (hb_face_t *face)
+  {
+    offsets.init ();
+    components.init ();
+
+    const OT::glyf_accelerator_t &glyf = *face->table.glyf;
+    if (!glyf.has_data ()) return;
+
+    unsigned num_glyphs = face->get_num_glyphs ();
+    if (unlikely (!offsets.alloc (num_glyphs + 1))) return;
+    for (hb_codepoint_t gid = 0; gid < num_glyphs; gid++)
+    {
+      offsets.push (components.length);
+      for (auto &item : glyf.glyph_for_gid (gid).get_composite_iterator ())
+	components.push (item.get_glyph_index ());
+    }
+    offsets.push (components.length);
+  }
+  void fini ()
+  {
+    offsets.fini ();
+    components.fini ();
+  }
+
+  bool in_error () const { return offsets.in_error () || components.in_error (); }
+
+  /* Same as glyf::accelerator_t::add_gid_and_children (). */
+  void add_gid_and_children (hb_codepoint_t gid, hb_set_t *gids_to_retain,
+			     unsigned int depth = 0) const
+  {
+    if (unlikely (depth++ > HB_MAX_NESTING_LEVEL)) return;
+    /* Check if is already visited */
+    if (gids_to_retain->has (gid)) return;
+
+    gids_to_retain->add (gid);
+
+    if (gid + 1 >= offsets.length) return;
+    for (unsigned i = offsets[gid]; i < offsets[gid + 1]; i++)
+      add_gid_and_children (components[i], gids_to_retain, depth);
+  }
+
+  hb_vector_t<unsigned> offsets;
+  hb_vector_t<hb_codepoint_t> components;
+};
+
+struct hb_subset_accelerator_t
+{
+  void init (hb_face_t *face_)
+  {
+    face = face_;
+    cmap_reverse_map.init ();
+    glyf_components.init ();
+  }
+  void fini ()
+  {
+    cmap_reverse_map.fini ();
+    glyf_components.fini ();
+  }
+
+  static void destroy (void *data)
+  {
+    hb_subset_accelerator_t *accel = (hb_subset_accelerator_t *) data;
+    accel->fini ();
+    hb_free (accel);
+  }
+
+  hb_face_t *face; /* MUST be JUST before the lazy loaders. */
+  hb_face_lazy_loader_t<hb_subset_cmap_reverse_map_t, 1> cmap_reverse_map;
+  hb_face_lazy_loader_t<hb_subset_glyf_components_t, 2> glyf_components;
+};
+
+static hb_user_data_key_t hb_subset_accelerator_key;
+
+/* Returns nullptr on allocation failure. */
+static const hb_subset_accelerator_t *
+_get_subset_accelerator (hb_face_t *face)
+{
+  /* Can't attach anything to the empty face; the Null accelerator loads
+   * the Null data for it, which is what it has anyway. */
+  if (unlikely (hb_object_is_inert (face)))
+    return &Null (hb_subset_accelerator_t);
+
+retry:
+  hb_subset_accelerator_t *accel = (hb_subset_accelerator_t *)
+				   hb_face_get_user_data (face, &hb_subset_accelerator_key);
+  if (likely (accel))
+    return accel;
+
+  accel = (hb_subset_accelerator_t *) hb_calloc (1, sizeof (hb_subset_accelerator_t));
+  if (unlikely (!accel))
+    return nullptr;
+  accel->init (face);
+
+  if (unlikely (!hb_face_set_user_data (face, &hb_subset_accelerator_key, accel,
+					hb_subset_accelerator_t::destroy, false)))
+  {
+    hb_subset_accelerator_t::destroy (accel);
+    /* Either another thread got there first, or we are out of memory. */
+    if (hb_face_get_user_data (face, &hb_subset_accelerator_key))
+      goto retry;
+    return nullptr;
+  }
+
+  return accel;
+}
+
 #ifndef HB_NO_SUBSET_CFF
 static inline void
 _add_cff_seac_components (const OT::cff1::accelerator_t &cff,
@@ -129,6 +299,7 @@ static void _collect_subset_layout (hb_face_t            *face,
 template <typename T>
 static inline void
 _closure_glyphs_lookups_features (hb_face_t          *face,
+				  const T            *table,
 				  hb_set_t           *gids_to_retain,
 				  const hb_set_t     *layout_features_to_retain,
 				  bool                retain_all_features,
@@ -136,7 +307,6 @@ _closure_glyphs_lookups_features (hb_face_t          *face,
 				  hb_map_t           *features,
 				  script_langsys_map *langsys_map)
 {
-  hb_blob_ptr_t<T> table = hb_sanitize_context_t ().reference_table<T> (face);
   hb_tag_t table_tag = table->tableTag;
   hb_set_t lookup_indices;
   _collect_subset_layout (face,
@@ -171,8 +341,6 @@ _closure_glyphs_lookups_features (hb_face_t          *face,
   feature_indices.clear ();
   table->prune_langsys (&duplicate_feature_map, langsys_map, &feature_indices);
   _remap_indexes (&feature_indices, features);
-
-  table.destroy ();
 }
 
 #endif
@@ -186,24 +354,21 @@ static inline void
 				     hb_map_t  *layout_variation_idx_map)
 {
   hb_blob_ptr_t<OT::GDEF> gdef = hb_sanitize_context_t ().reference_table<OT::GDEF> (face);
-  hb_blob_ptr_t<OT::GPOS> gpos = hb_sanitize_context_t ().reference_table<OT::GPOS> (face);
 
   if (!gdef->has_data ())
   {
     gdef.destroy ();
-    gpos.destroy ();
     return;
   }
   OT::hb_collect_variation_indices_context_t c (layout_variation_indices, glyphset, gpos_lookups);
   gdef->collect_variation_indices (&c);
 
   if (hb_ot_layout_has_positioning (face))
-    gpos->collect_variation_indices (&c);
+    face->table.GPOS->table->collect_variation_indices (&c);
 
   gdef->remap_layout_variation_indices (layout_variation_indices, layout_variation_idx_map);
 
   gdef.destroy ();
-  gpos.destroy ();
 }
 #endif
 
@@ -212,10 +377,7 @@ _cmap_closure (hb_face_t           *face,
 	       const hb_set_t      *unicodes,
 	       hb_set_t            *glyphset)
 {
-  OT::cmap::accelerator_t cmap;
-  cmap.init (face);
-  cmap.table->closure_glyphs (unicodes, glyphset);
-  cmap.fini ();
+  face->table.cmap->table->closure_glyphs (unicodes, glyphset);
 }
 
 static inline void
@@ -231,12 +393,12 @@ _remove_invalid_gids (hb_set_t *glyphs,
 }
 
 static void
-_populate_unicodes_to_retain (const hb_set_t *unicodes,
+_populate_unicodes_to_retain (const hb_subset_accelerator_t *accel,
+			      const hb_set_t *unicodes,
                               const hb_set_t *glyphs,
                               hb_subset_plan_t *plan)
 {
-  OT::cmap::accelerator_t cmap;
-  cmap.init (plan->source);
+  const OT::cmap_accelerator_t &cmap = *plan->source->table.cmap;
 
   for (hb_codepoint_t cp : *unicodes)
   {
@@ -252,41 +414,35 @@ _populate_unicodes_to_retain (const hb_set_t *unicodes,
   }
 
   if (glyphs->is_empty ())
-  {
-    cmap.fini ();
     return;
-  }
 
-  hb_map_t unicode_glyphid_map;
-  cmap.collect_mapping (hb_set_get_empty (), &unicode_glyphid_map);
-  cmap.fini ();
+  const hb_subset_cmap_reverse_map_t &reverse_map = *accel->cmap_reverse_map;
+  if (unlikely (!plan->check_success (!reverse_map.in_error ())))
+    return;
 
-  for (hb_pair_t<hb_codepoint_t, hb_codepoint_t> cp_gid :
-       + unicode_glyphid_map.iter () | hb_filter (glyphs, hb_second))
-  {
-    plan->unicodes->add (cp_gid.first);
-    plan->codepoint_to_glyph->set (cp_gid.first, cp_gid.second);
-  }
+  for (hb_codepoint_t gid : glyphs->iter ())
+    for (const auto &item : reverse_map.unicodes_for (gid))
+    {
+      plan->unicodes->add (item.unicode);
+      plan->codepoint_to_glyph->set (item.unicode, gid);
+    }
 }
 
 static void
-_populate_gids_to_retain (hb_subset_plan_t* plan,
+_populate_gids_to_retain (const hb_subset_accelerator_t *accel,
+			  hb_subset_plan_t* plan,
 			  const hb_set_t *unicodes,
 			  const hb_set_t *input_glyphs_to_retain,
 			  bool close_over_gsub,
 			  bool close_over_gpos,
 			  bool close_over_gdef)
 {
-  OT::glyf::accelerator_t glyf;
-#ifndef HB_NO_SUBSET_CFF
-  OT::cff1::accelerator_t cff;
-#endif
-  OT::COLR::accelerator_t colr;
-  glyf.init (plan->source);
+  const hb_subset_glyf_components_t &glyf_components = *accel->glyf_components;
+  if (unlikely (!plan->check_success (!glyf_components.in_error ())))
+    return;
 #ifndef HB_NO_SUBSET_CFF
-  cff.init (plan->source);
+  const OT::cff1_accelerator_t &cff = *plan->source->table.cff1;
 #endif
-  colr.init (plan->source);
 
   plan->_glyphset_gsub->add (0); // Not-def
   hb_set_union (plan->_glyphset_gsub, input_glyphs_to_retain);
@@ -296,17 +452,20 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
 #ifndef HB_NO_SUBSET_LAYOUT
   if (close_over_gsub)
     // closure all glyphs/lookups/features needed for GSUB substitutions.
-    _closure_glyphs_lookups_features<OT::GSUB> (plan->source, plan->_glyphset_gsub, plan->layout_features, plan->retain_all_layout_features, plan->gsub_lookups, plan->gsub_features, plan->gsub_langsys);
+    _closure_glyphs_lookups_features<OT::GSUB> (plan->source, plan->source->table.GSUB->table, plan->_glyphset_gsub, plan->layout_features, plan->retain_all_layout_features, plan->gsub_lookups, plan->gsub_features, plan->gsub_langsys);
 
   if (close_over_gpos)
-    _closure_glyphs_lookups_features<OT::GPOS> (plan->source, plan->_glyphset_gsub, plan->layout_features, plan->retain_all_layout_features, plan->gpos_lookups, plan->gpos_features, plan->gpos_langsys);
+    _closure_glyphs_lookups_features<OT::GPOS> (plan->source, plan->source->table.GPOS->table, plan->_glyphset_gsub, plan->layout_features, plan->retain_all_layout_features, plan->gpos_lookups, plan->gpos_features, plan->gpos_langsys);
 #endif
   _remove_invalid_gids (plan->_glyphset_gsub, plan->source->get_num_glyphs ());
 
-  // Collect all glyphs referenced by COLRv0
   hb_set_t* cur_glyphset = plan->_glyphset_gsub;
+#ifndef HB_NO_COLOR
+  const OT::COLR &colr = *plan->source->table.COLR;
+
+  // Collect all glyphs referenced by COLRv0
   hb_set_t glyphset_colrv0;
-  if (colr.is_valid ())
+  if (plan->source->table.COLR.get_blob ()->length)
   {
     glyphset_colrv0.union_ (*cur_glyphset);
     for (hb_codepoint_t gid : cur_glyphset->iter ())
@@ -321,14 +480,14 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
   colr.closure_forV1 (cur_glyphset, &layer_indices, &palette_indices);
   _remap_indexes (&layer_indices, plan->colrv1_layers);
   _remap_palette_indexes (&palette_indices, plan->colr_palettes);
-  colr.fini ();
+#endif
   _remove_invalid_gids (cur_glyphset, plan->source->get_num_glyphs ());
 
   // Populate a full set of glyphs to retain by adding all referenced
   // composite glyphs.
   for (hb_codepoint_t gid : cur_glyphset->iter ())
   {
-    glyf.add_gid_and_children (gid, plan->_glyphset);
+    glyf_components.add_gid_and_children (gid, plan->_glyphset);
 #ifndef HB_NO_SUBSET_CFF
     if (cff.is_valid ())
       _add_cff_seac_components (cff, gid, plan->_glyphset);
@@ -346,11 +505,6 @@ _populate_gids_to_retain (hb_subset_plan_t* plan,
                                        plan->layout_variation_indices,
                                        plan->layout_variation_idx_map);
 #endif
-
-#ifndef HB_NO_SUBSET_CFF
-  cff.fini ();
-#endif
-  glyf.fini ();
 }
 
 static void
@@ -461,9 +615,14 @@ hb_subset_plan_create (hb_face_t         *face,
     return plan;
   }
 
-  _populate_unicodes_to_retain (input->unicodes, input->glyphs, plan);
+  const hb_subset_accelerator_t *accel = _get_subset_accelerator (face);
+  if (unlikely (!plan->check_success (accel)))
+    return plan;
+
+  _populate_unicodes_to_retain (accel, input->unicodes, input->glyphs, plan);
 
-  _populate_gids_to_retain (plan,
+  _populate_gids_to_retain (accel,
+			    plan,
 			    input->unicodes,
 			    input->glyphs,
 			    !input->drop_tables->has (HB_OT_TAG_GSUB),
@@ -295,6 +295,53 @@ _subset_table (hb_subset_plan_t *plan, hb_tag_t tag)
   }
 }
 
+#ifdef HB_EXPERIMENTAL_API
+struct hb_subset_table_task_t
+{
+  hb_tag_t tag;
+  /* Copy of the shared plan with its own face builder as dest, so that
+   * the tables can be added to the subset in the serial order. */
+  hb_subset_plan_t plan;
+  bool success;
+};
+
+static void
+_subset_table_task (unsigned int index, void *task_data)
+{
+  hb_subset_table_task_t *task = (hb_subset_table_task_t *) task_data + index;
+  task->success = _subset_table (&task->plan, task->tag);
+}
+
+static bool
+_subset_tables_parallel (hb_subset_plan_t *plan,
+			 hb_array_t<const hb_tag_t> tags,
+			 const hb_subset_input_t *input)
+{
+  hb_vector_t<hb_subset_table_task_t> tasks;
+  if (unlikely (!tasks.resize (tags.length))) return false;
+
+  for (unsigned i = 0; i < tags.length; i++)
+  {
+    tasks[i].tag = tags[i];
+    tasks[i].plan = *plan;
+    tasks[i].plan.dest = hb_face_builder_create ();
+  }
+
+  input->parallel_for_func (tasks.length, _subset_table_task, tasks.arrayZ,
+			    input->parallel_for_user_data);
+
+  bool success = true;
+  for (unsigned i = 0; i < tasks.length; i++)
+  {
+    success = success &&
+	      tasks[i].success &&
+	      hb_face_builder_add_tables_from (plan->dest, tasks[i].plan.dest);
+    hb_face_destroy (tasks[i].plan.dest);
+  }
+  return success;
+}
+#endif
+
 /**
  * hb_subset:
  * @source: font face data to be subset.
@@ -314,7 +361,7 @@ hb_subset (hb_face_t *source, hb_subset_input_t *input)
   }
 
   hb_set_t tags_set;
-  bool success = true;
+  hb_vector_t<hb_tag_t> tags;
   hb_tag_t table_tags[32];
   unsigned offset = 0, num_tables = ARRAY_LENGTH (table_tags);
   while ((hb_face_get_table_tags (source, offset, &num_tables, table_tags), num_tables))
@@ -324,12 +371,19 @@ hb_subset (hb_face_t *source, hb_subset_input_t *input)
       hb_tag_t tag = table_tags[i];
       if (_should_drop_table (plan, tag) && !tags_set.has (tag)) continue;
       tags_set.add (tag);
-      success = _subset_table (plan, tag);
-      if (unlikely (!success)) goto end;
+      tags.push (tag);
     }
     offset += num_tables;
   }
-end:
+
+  bool success = !tags.in_error ();
+#ifdef HB_EXPERIMENTAL_API
+  if (success && input->parallel_for_func)
+    success = _subset_tables_parallel (plan, tags, input);
+  else
+#endif
+  for (unsigned i = 0; success && i < tags.length; i++)
+    success = _subset_table (plan, tags[i]);
 
   hb_face_t *result = success ? hb_face_reference (plan->dest) : hb_face_get_empty ();
 
@@ -117,6 +117,44 @@ hb_subset_input_set_no_prune_unicode_ranges (hb_subset_input_t *subset_input,
 HB_EXTERN hb_bool_t
 hb_subset_input_get_no_prune_unicode_ranges (hb_subset_input_t *subset_input);
 
+#ifdef HB_EXPERIMENTAL_API
+/**
+ * hb_subset_task_func_t:
+ * @index: index of the task to run.
+ * @task_data: data passed to the #hb_subset_parallel_for_func_t.
+ *
+ * A unit of work handed out by hb_subset() to a
+ * #hb_subset_parallel_for_func_t.
+ *
+ * Since: EXPERIMENTAL
+ **/
+typedef void (*hb_subset_task_func_t) (unsigned int  index,
+				       void         *task_data);
+
+/**
+ * hb_subset_parallel_for_func_t:
+ * @count: number of tasks.
+ * @task: function to run for each task.
+ * @task_data: data to pass to @task.
+ * @user_data: data passed to hb_subset_input_set_parallel_for_func().
+ *
+ * Runs @task for every index from zero to @count - 1, in any order and
+ * possibly concurrently, and returns once all of them are done.
+ *
+ * Since: EXPERIMENTAL
+ **/
+typedef void (*hb_subset_parallel_for_func_t) (unsigned int           count,
+					       hb_subset_task_func_t  task,
+					       void                  *task_data,
+					       void                  *user_data);
+
+HB_EXTERN void
+hb_subset_input_set_parallel_for_func (hb_subset_input_t             *subset_input,
+				       hb_subset_parallel_for_func_t  func,
+				       void                          *user_data,
+				       hb_destroy_func_t              destroy);
+#endif
+
 /* hb_subset () */
 HB_EXTERN hb_face_t *
 hb_subset (hb_face_t *source, hb_subset_input_t *input);
@@ -36,6 +36,25 @@ hb_ucd_general_category (hb_unicode_funcs_t *ufuncs HB_UNUSED,
   return (hb_unicode_general_category_t) _hb_ucd_gc (unicode);
 }
 
+static void
+hb_ucd_general_categories (unsigned int          count,
+			   const hb_codepoint_t *first_unicode,
+			   unsigned int          unicode_stride,
+			   uint16_t             *first_gen_cat,
+			   unsigned int          gen_cat_stride)
+{
+  for (unsigned int i = 0; i < count; i++)
+  {
+    hb_codepoint_t u = *first_unicode;
+    unsigned int gen_cat = _hb_ucd_gc (u);
+    if (unlikely (HB_UNICODE_GENERAL_CATEGORY_IS_MARK (gen_cat)))
+      gen_cat |= hb_unicode_funcs_t::modified_combining_class (u, _hb_ucd_ccc (u)) << 8;
+    *first_gen_cat = gen_cat;
+    first_unicode = &StructAtOffsetUnaligned<hb_codepoint_t> (first_unicode, unicode_stride);
+    first_gen_cat = &StructAtOffsetUnaligned<uint16_t> (first_gen_cat, gen_cat_stride);
+  }
+}
+
 static hb_codepoint_t
 hb_ucd_mirroring (hb_unicode_funcs_t *ufuncs HB_UNUSED,
 		  hb_codepoint_t unicode,
@@ -219,6 +238,8 @@ static struct hb_ucd_unicode_funcs_lazy_loader_t : hb_unicode_funcs_lazy_loader_
     hb_unicode_funcs_set_script_func (funcs, hb_ucd_script, nullptr, nullptr);
     hb_unicode_funcs_set_compose_func (funcs, hb_ucd_compose, nullptr, nullptr);
     hb_unicode_funcs_set_decompose_func (funcs, hb_ucd_decompose, nullptr, nullptr);
+    if (likely (!hb_object_is_immutable (funcs)))
+      funcs->general_categories_func = hb_ucd_general_categories;
 
     hb_unicode_funcs_make_immutable (funcs);
 
@@ -36,6 +36,20 @@
 
 extern HB_INTERNAL const uint8_t _hb_modified_combining_class[256];
 
+#define HB_UNICODE_GENERAL_CATEGORY_IS_MARK(gen_cat) \
+	(FLAG_UNSAFE (gen_cat) & \
+	 (FLAG (HB_UNICODE_GENERAL_CATEGORY_SPACING_MARK) | \
+	  FLAG (HB_UNICODE_GENERAL_CATEGORY_ENCLOSING_MARK) | \
+	  FLAG (HB_UNICODE_GENERAL_CATEGORY_NON_SPACING_MARK)))
+
+#define HB_UNICODE_GENERAL_CATEGORY_IS_LETTER(gen_cat) \
+	(FLAG_UNSAFE (gen_cat) & \
+	 (FLAG (HB_UNICODE_GENERAL_CATEGORY_LOWERCASE_LETTER) | \
+	  FLAG (HB_UNICODE_GENERAL_CATEGORY_MODIFIER_LETTER) | \
+	  FLAG (HB_UNICODE_GENERAL_CATEGORY_OTHER_LETTER) | \
+	  FLAG (HB_UNICODE_GENERAL_CATEGORY_TITLECASE_LETTER) | \
+	  FLAG (HB_UNICODE_GENERAL_CATEGORY_UPPERCASE_LETTER)))
+
 /*
  * hb_unicode_funcs_t
  */
@@ -104,6 +118,11 @@ HB_UNICODE_FUNCS_IMPLEMENT_CALLBACKS_SIMPLE
 
   unsigned int
   modified_combining_class (hb_codepoint_t u)
+  { return modified_combining_class (u, combining_class (u)); }
+
+  /* Modified combining class of @u, whose combining class is @klass. */
+  static unsigned int
+  modified_combining_class (hb_codepoint_t u, unsigned int klass)
   {
     /* XXX This hack belongs to the USE shaper (for Tai Tham):
      * Reorder SAKOT to ensure it comes after any tone marks. */
@@ -115,7 +134,37 @@ HB_UNICODE_FUNCS_IMPLEMENT_CALLBACKS_SIMPLE
     /* Reorder TSA -PHRU to reorder before U+0F74 */
     if (unlikely (u == 0x0F39u)) return 127;
 
-    return _hb_modified_combining_class[combining_class (u)];
+    return _hb_modified_combining_class[klass];
+  }
+
+  /* Fetches the general category of @count characters at once, with the
+   * modified combining class in the high byte for non-ASCII marks,
+   * storing them every @gen_cat_stride bytes; as get_nominal_glyphs()
+   * does for fonts. */
+  void general_categories (unsigned int          count,
+			   const hb_codepoint_t *first_unicode,
+			   unsigned int          unicode_stride,
+			   uint16_t             *first_gen_cat,
+			   unsigned int          gen_cat_stride)
+  {
+    if (general_categories_func)
+    {
+      general_categories_func (count,
+			       first_unicode, unicode_stride,
+			       first_gen_cat, gen_cat_stride);
+      return;
+    }
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+      hb_codepoint_t u = *first_unicode;
+      unsigned int gen_cat = general_category (u);
+      if (unlikely (u >= 0x80u && HB_UNICODE_GENERAL_CATEGORY_IS_MARK (gen_cat)))
+	gen_cat |= modified_combining_class (u) << 8;
+      *first_gen_cat = gen_cat;
+      first_unicode = (const hb_codepoint_t *) ((const char *) first_unicode + unicode_stride);
+      first_gen_cat = (uint16_t *) ((char *) first_gen_cat + gen_cat_stride);
+    }
   }
 
   static hb_bool_t
@@ -260,6 +309,16 @@ HB_UNICODE_FUNCS_IMPLEMENT_CALLBACKS_SIMPLE
     HB_UNICODE_FUNCS_IMPLEMENT_CALLBACKS
 #undef HB_UNICODE_FUNC_IMPLEMENT
   } destroy;
+
+  /* Batch general_categories() of the built-in UCD functions.  Not public
+   * API; not inherited by children, which may override general_category()
+   * or combining_class(). */
+  typedef void (*general_categories_func_t) (unsigned int          count,
+					     const hb_codepoint_t *first_unicode,
+					     unsigned int          unicode_stride,
+					     uint16_t             *first_gen_cat,
+					     unsigned int          gen_cat_stride);
+  general_categories_func_t general_categories_func;
 };
 DECLARE_NULL_INSTANCE (hb_unicode_funcs_t);
 
@@ -353,20 +412,6 @@ DECLARE_NULL_INSTANCE (hb_unicode_funcs_t);
 
 /* Misc */
 
-#define HB_UNICODE_GENERAL_CATEGORY_IS_MARK(gen_cat) \
-	(FLAG_UNSAFE (gen_cat) & \
-	 (FLAG (HB_UNICODE_GENERAL_CATEGORY_SPACING_MARK) | \
-	  FLAG (HB_UNICODE_GENERAL_CATEGORY_ENCLOSING_MARK) | \
-	  FLAG (HB_UNICODE_GENERAL_CATEGORY_NON_SPACING_MARK)))
-
-#define HB_UNICODE_GENERAL_CATEGORY_IS_LETTER(gen_cat) \
-	(FLAG_UNSAFE (gen_cat) & \
-	 (FLAG (HB_UNICODE_GENERAL_CATEGORY_LOWERCASE_LETTER) | \
-	  FLAG (HB_UNICODE_GENERAL_CATEGORY_MODIFIER_LETTER) | \
-	  FLAG (HB_UNICODE_GENERAL_CATEGORY_OTHER_LETTER) | \
-	  FLAG (HB_UNICODE_GENERAL_CATEGORY_TITLECASE_LETTER) | \
-	  FLAG (HB_UNICODE_GENERAL_CATEGORY_UPPERCASE_LETTER)))
-
 /*
  * Ranges, used for bsearch tables.
  */
@@ -282,5 +282,22 @@ main (int argc, char **argv)
   assert (hb_range (-2, -8, -3).len () == 2);
   assert (hb_range (-2, -7, -3).len () == 2);
 
+  {
+    hb_set_t inverted;
+    inverted.invert ();
+    assert (hb_len (inverted.iter ()) == HB_SET_VALUE_INVALID);
+    assert (*inverted.iter () == 0);
+    inverted.clear ();
+    inverted.add_range (10, 19);
+    inverted.invert ();
+    inverted.del (5);
+    auto it = inverted.iter ();
+    assert (it.len () == HB_SET_VALUE_INVALID - 11);
+    assert (*it == 0);
+    it += 5;
+    assert (*it == 6);
+    assert (it.len () == HB_SET_VALUE_INVALID - 16);
+  }
+
   return 0;
 }
@@ -924,6 +924,71 @@ test_buffer_serialize_deserialize (void)
 
 }
 
+/* In gsub-rewind.ttf, ccmp first turns each 'h' into 63 'c's.  Then, for
+ * an 'a' followed by 'b', 'e' or 'f', it expands the latter into 2, 5 or
+ * 40 'c's before turning the 'a' into 'd', rewinding the output past what
+ * was consumed of the input. */
+static void
+check_rewind (hb_font_t *font, const char *pair, unsigned int repeat,
+	      char tail, unsigned int tail_length)
+{
+  enum { A = 1, B, C, D, E, F, H };
+  unsigned int expansion = pair[1] == 'b' ? 2 : pair[1] == 'e' ? 5 : 40;
+  unsigned int tail_expansion = tail == 'h' ? 63 : 1;
+  unsigned int text_length = 2 * repeat + tail_length;
+  unsigned int expected_length = (1 + expansion) * repeat + tail_expansion * tail_length;
+  char *text = g_malloc (text_length);
+  hb_buffer_t *b = hb_buffer_create ();
+  hb_glyph_info_t *info;
+  unsigned int i, len;
+
+  for (i = 0; i < repeat; i++)
+    memcpy (text + 2 * i, pair, 2);
+  memset (text + 2 * repeat, tail, tail_length);
+
+  hb_buffer_add_utf8 (b, text, text_length, 0, text_length);
+  hb_buffer_guess_segment_properties (b);
+  hb_shape (font, b, NULL, 0);
+  g_assert (hb_buffer_allocation_successful (b));
+
+  info = hb_buffer_get_glyph_infos (b, &len);
+  g_assert_cmpuint (len, ==, expected_length);
+  for (i = 0; i < len; i++)
+    g_assert_cmpuint (info[i].codepoint, ==,
+		      i < (1 + expansion) * repeat && i % (1 + expansion) == 0 ? D : C);
+
+  hb_buffer_destroy (b);
+  g_free (text);
+}
+
+static void
+test_buffer_rewind (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/gsub-rewind.ttf");
+  hb_font_t *font = hb_font_create (face);
+  unsigned int n;
+  hb_face_destroy (face);
+
+  /* Rewinding past the start of the input shifts the rest of it forward,
+   * plus as much slack as the allocation allows.  Walk the tail across
+   * allocation sizes so that the slack is cut short in some runs, and
+   * rewind repeatedly. */
+  for (n = 0; n < 200; n++)
+  {
+    check_rewind (font, "ab", 1, 'c', n);
+    check_rewind (font, "af", 1, 'c', n);
+    check_rewind (font, "ae", n, 'c', 0);
+    check_rewind (font, "af", n, 'c', 30);
+  }
+
+  /* Grow the buffer close to its max_len before rewinding; the slack
+   * must not take it past max_len. */
+  for (n = 200; n < 420; n += 7)
+    check_rewind (font, "ab", 1, 'h', n);
+
+  hb_font_destroy (font);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -949,6 +1014,7 @@ main (int argc, char **argv)
   hb_test_add (test_buffer_utf32_conversion);
   hb_test_add (test_buffer_empty);
   hb_test_add (test_buffer_serialize_deserialize);
+  hb_test_add (test_buffer_rewind);
 
   return hb_test_run();
 }
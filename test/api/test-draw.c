@@ -890,6 +890,198 @@ test_hb_draw_stroking (void)
   }
 }
 
+static void
+test_hb_glyph_path (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSerifVariable-Roman-VVAR.abc.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  char str[1024];
+  user_data_t user_data = {
+    .str = str,
+    .size = sizeof (str),
+    .consumed = 0
+  };
+
+  hb_glyph_path_t *path = hb_font_get_glyph_path (font, 4);
+  g_assert (path == hb_glyph_path_get_empty ());
+  hb_glyph_path_draw (path, funcs, &user_data);
+  g_assert_cmpuint (user_data.consumed, ==, 0);
+  hb_glyph_path_destroy (path);
+
+  path = hb_font_get_glyph_path (font, 3);
+  unsigned verbs_length, points_length;
+  const uint8_t *verbs = hb_glyph_path_get_verbs (path, &verbs_length);
+  const hb_position_t *points = hb_glyph_path_get_points (path, &points_length);
+  g_assert_cmpuint (verbs_length, ==, 29);
+  g_assert_cmpuint (points_length, ==, 52);
+  g_assert_cmpuint (verbs[0], ==, HB_GLYPH_PATH_VERB_MOVE_TO);
+  g_assert_cmpuint (verbs[1], ==, HB_GLYPH_PATH_VERB_QUADRATIC_TO);
+  g_assert_cmpuint (verbs[28], ==, HB_GLYPH_PATH_VERB_CLOSE_PATH);
+  g_assert_cmpint (points[0], ==, 275);
+  g_assert_cmpint (points[1], ==, 442);
+
+  /* Cached on the font. */
+  hb_glyph_path_t *path2 = hb_font_get_glyph_path (font, 3);
+  g_assert (path2 == path);
+  hb_glyph_path_destroy (path2);
+
+  user_data.consumed = 0;
+  hb_glyph_path_draw (path, funcs, &user_data);
+  char expected[] = "M275,442Q232,442 198,420Q164,397 145,353Q126,309 126,245"
+		    "Q126,182 147,139Q167,95 204,73Q240,50 287,50Q330,50 367,70"
+		    "Q404,90 427,128L451,116Q431,54 384,21Q336,-13 266,-13"
+		    "Q198,-13 148,18Q97,48 70,104Q43,160 43,236Q43,314 76,371"
+		    "Q108,427 160,457Q212,487 272,487Q316,487 354,470Q392,453 417,424"
+		    "Q442,395 448,358Q441,321 403,321Q378,321 367,334"
+		    "Q355,347 350,366L325,454L371,417Q346,430 321,436Q296,442 275,442Z";
+  g_assert_cmpmem (str, user_data.consumed, expected, sizeof (expected) - 1);
+
+  /* Quadratics are converted for funcs that don't take them, like hb_font_draw_glyph() does. */
+  user_data.consumed = 0;
+  hb_glyph_path_draw (path, funcs2, &user_data);
+  char expected2[] = "M275,442C246,442 221,435 198,420C175,405 158,382 145,353"
+		     "C132,324 126,288 126,245C126,203 133,168 147,139C160,110 179,88 204,73"
+		     "C228,58 256,50 287,50C316,50 342,57 367,70C392,83 412,103 427,128"
+		     "L451,116C438,75 415,43 384,21C352,-2 313,-13 266,-13C221,-13 181,-3 148,18"
+		     "C114,38 88,67 70,104C52,141 43,185 43,236C43,288 54,333 76,371"
+		     "C97,408 125,437 160,457C195,477 232,487 272,487C301,487 329,481 354,470"
+		     "C379,459 400,443 417,424C434,405 444,383 448,358C443,333 428,321 403,321"
+		     "C386,321 374,325 367,334C359,343 353,353 350,366L325,454L371,417"
+		     "C354,426 338,432 321,436C304,440 289,442 275,442Z";
+  g_assert_cmpmem (str, user_data.consumed, expected2, sizeof (expected2) - 1);
+
+  hb_variation_t var;
+  var.tag = HB_TAG ('w','g','h','t');
+  var.value = 800;
+  hb_font_set_variations (font, &var, 1);
+
+  /* The font changed; a new path is made, the old one stays as it was. */
+  path2 = hb_font_get_glyph_path (font, 3);
+  g_assert (path2 != path);
+  user_data.consumed = 0;
+  hb_glyph_path_draw (path2, funcs, &user_data);
+  char expected3[] = "M323,448Q297,448 271,430Q244,412 226,371Q209,330 209,261"
+		     "Q209,204 225,166Q242,127 272,107Q303,86 344,86Q378,86 404,101"
+		     "Q430,115 451,137L488,103Q458,42 404,13Q350,-16 279,-16"
+		     "Q211,-16 153,13Q95,41 60,98Q25,156 25,241Q25,323 62,382"
+		     "Q99,440 163,470Q226,501 303,501Q357,501 399,480Q440,460 464,426"
+		     "Q488,392 492,352Q475,297 420,297Q390,297 366,319Q342,342 339,401"
+		     "L333,469L411,427Q387,438 367,443Q348,448 323,448Z";
+  g_assert_cmpmem (str, user_data.consumed, expected3, sizeof (expected3) - 1);
+  hb_glyph_path_destroy (path2);
+
+  user_data.consumed = 0;
+  hb_glyph_path_draw (path, funcs, &user_data);
+  g_assert_cmpmem (str, user_data.consumed, expected, sizeof (expected) - 1);
+  hb_glyph_path_destroy (path);
+
+  hb_font_destroy (font);
+}
+
+static void
+test_hb_glyph_path_cff (void)
+{
+  char str[1024];
+  user_data_t user_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+
+  {
+    hb_face_t *face = hb_test_open_font_file ("fonts/cff1_seac.otf");
+    hb_font_t *font = hb_font_create (face);
+    hb_face_destroy (face);
+
+    hb_glyph_path_t *path = hb_font_get_glyph_path (font, 3);
+    user_data.consumed = 0;
+    hb_glyph_path_draw (path, funcs, &user_data);
+    char expected[] = "M203,367C227,440 248,512 268,588L272,588C293,512 314,440 338,367L369,267L172,267L203,367Z"
+		      "M3,0L88,0L151,200L390,200L452,0L541,0L319,656L225,656L3,0Z"
+		      "M300,653L342,694L201,861L143,806L300,653Z";
+    g_assert_cmpmem (str, user_data.consumed, expected, sizeof (expected) - 1);
+
+    user_data.consumed = 0;
+    hb_glyph_path_draw_transformed (path, funcs, &user_data, 2.f, 0.f, .5f, -1.f, 10.f, 20.f);
+    char expected2[] = "M600,-347C684,-420 762,-492 840,-568L848,-568C852,-492 858,-420 870,-347"
+		       "L882,-247L488,-247L600,-347Z"
+		       "M16,20L186,20L412,-180L890,-180L914,20L1092,20L976,-636L788,-636L16,20Z"
+		       "M937,-633L1041,-674L843,-841L699,-786L937,-633Z";
+    g_assert_cmpmem (str, user_data.consumed, expected2, sizeof (expected2) - 1);
+    hb_glyph_path_destroy (path);
+
+    hb_font_destroy (font);
+  }
+
+  {
+    hb_face_t *face = hb_test_open_font_file ("fonts/AdobeVFPrototype.abc.otf");
+    hb_font_t *font = hb_font_create (face);
+    hb_face_destroy (face);
+
+    hb_variation_t var;
+    var.tag = HB_TAG ('w','g','h','t');
+    var.value = 800;
+    hb_font_set_variations (font, &var, 1);
+
+    hb_glyph_path_t *path = hb_font_get_glyph_path (font, 3);
+    user_data.consumed = 0;
+    hb_glyph_path_draw (path, funcs, &user_data);
+    char expected[] = "M323,448C356,448 380,441 411,427L333,469L339,401"
+		      "C343,322 379,297 420,297C458,297 480,314 492,352"
+		      "C486,433 412,501 303,501C148,501 25,406 25,241"
+		      "C25,70 143,-16 279,-16C374,-16 447,22 488,103L451,137"
+		      "C423,107 390,86 344,86C262,86 209,148 209,261C209,398 271,448 323,448Z";
+    g_assert_cmpmem (str, user_data.consumed, expected, sizeof (expected) - 1);
+    hb_glyph_path_destroy (path);
+
+    hb_font_destroy (font);
+  }
+}
+
+static void
+test_hb_draw_font_face_changes (void)
+{
+  hb_face_t *serif = hb_test_open_font_file ("fonts/SourceSerifVariable-Roman-VVAR.abc.ttf");
+  hb_face_t *sans = hb_test_open_font_file ("fonts/SourceSansVariable-Roman.abc.ttf");
+  int coords[1] = { 8000 };
+
+  hb_font_t *font = hb_font_create (serif);
+  hb_font_set_var_coords_normalized (font, coords, 1);
+  hb_font_t *expected = hb_font_create (sans);
+  hb_font_set_var_coords_normalized (expected, coords, 1);
+
+  char str[1024], expected_str[1024];
+  user_data_t user_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+  user_data_t expected_user_data = {
+    .str = expected_str,
+    .size = sizeof (expected_str)
+  };
+
+  /* Outlines cached for the old face must not be drawn for the new one. */
+  for (hb_codepoint_t gid = 0; gid < 4; gid++)
+  {
+    user_data.consumed = 0;
+    hb_font_draw_glyph (font, gid, funcs, &user_data);
+  }
+  hb_font_set_face (font, sans);
+  for (hb_codepoint_t gid = 0; gid < 4; gid++)
+  {
+    user_data.consumed = expected_user_data.consumed = 0;
+    g_assert (hb_font_draw_glyph (font, gid, funcs, &user_data) ==
+	      hb_font_draw_glyph (expected, gid, funcs, &expected_user_data));
+    g_assert_cmpmem (str, user_data.consumed, expected_str, expected_user_data.consumed);
+  }
+
+  hb_font_destroy (expected);
+  hb_font_destroy (font);
+  hb_face_destroy (sans);
+  hb_face_destroy (serif);
+}
+
 static void
 test_hb_draw_immutable (void)
 {
@@ -930,7 +1122,10 @@ main (int argc, char **argv)
   hb_test_add (test_hb_draw_font_kit_variations_tests);
   hb_test_add (test_hb_draw_estedad_vf);
   hb_test_add (test_hb_draw_stroking);
+  hb_test_add (test_hb_draw_font_face_changes);
   hb_test_add (test_hb_draw_immutable);
+  hb_test_add (test_hb_glyph_path);
+  hb_test_add (test_hb_glyph_path_cff);
   unsigned result = hb_test_run ();
 
   hb_draw_funcs_destroy (funcs);
@@ -427,6 +427,32 @@ test_fontfuncs_parallels (void)
   hb_font_destroy (font2);
 }
 
+static void
+test_font_nominal_glyph_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  hb_codepoint_t unicodes[] = { 0x0061u, 0xFFFF41u, 0x0062u, 0xFFFF62u };
+  hb_codepoint_t glyphs[4] = {0};
+  hb_codepoint_t glyph;
+
+  /* Out-of-range codepoints must not hit empty or filled cache slots. */
+  g_assert (!hb_font_get_nominal_glyph (font, 0xFFFF41u, &glyph));
+  g_assert_cmpuint (hb_font_get_nominal_glyphs (font, 4,
+						unicodes, sizeof (unicodes[0]),
+						glyphs, sizeof (glyphs[0])), ==, 1);
+  g_assert_cmpuint (glyphs[0], ==, 1);
+
+  g_assert (hb_font_get_nominal_glyph (font, 0x0062u, &glyph));
+  g_assert_cmpuint (glyph, ==, 2);
+  g_assert (!hb_font_get_nominal_glyph (font, 0xFFFF62u, &glyph));
+  g_assert (!hb_font_get_nominal_glyph (font, 0xFFFF41u, &glyph));
+
+  hb_font_destroy (font);
+}
+
 static void
 test_font_empty (void)
 {
@@ -611,6 +637,7 @@ main (int argc, char **argv)
   hb_test_add (test_fontfuncs_nil);
   hb_test_add (test_fontfuncs_subclassing);
   hb_test_add (test_fontfuncs_parallels);
+  hb_test_add (test_font_nominal_glyph_cache);
 
   hb_test_add (test_font_empty);
   hb_test_add (test_font_properties);
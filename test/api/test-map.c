@@ -104,6 +104,40 @@ test_map_refcount (void)
   /* Now you can't access them anymore */
 }
 
+static void
+test_map_many (void)
+{
+  hb_map_t *m = hb_map_create ();
+  unsigned int i;
+
+  /* Enough keys to go through several resizes; deleting every other
+   * one shifts the rest of their probe runs back. */
+  for (i = 0; i < 5000; i++)
+    hb_map_set (m, i * 7, i);
+  g_assert_cmpint (hb_map_get_population (m), ==, 5000);
+
+  for (i = 0; i < 5000; i += 2)
+    hb_map_del (m, i * 7);
+  g_assert_cmpint (hb_map_get_population (m), ==, 2500);
+
+  for (i = 0; i < 5000; i++)
+  {
+    if (i % 2)
+      g_assert_cmpint (hb_map_get (m, i * 7), ==, i);
+    else
+      g_assert (!hb_map_has (m, i * 7));
+    g_assert (!hb_map_has (m, i * 7 + 1));
+  }
+
+  for (i = 0; i < 5000; i += 2)
+    hb_map_set (m, i * 7, i + 1);
+  for (i = 0; i < 5000; i++)
+    g_assert_cmpint (hb_map_get (m, i * 7), ==, i % 2 ? i : i + 1);
+  g_assert_cmpint (hb_map_get_population (m), ==, 5000);
+
+  hb_map_destroy (m);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -112,6 +146,7 @@ main (int argc, char **argv)
   hb_test_add (test_map_basic);
   hb_test_add (test_map_userdata);
   hb_test_add (test_map_refcount);
+  hb_test_add (test_map_many);
 
   return hb_test_run();
 }
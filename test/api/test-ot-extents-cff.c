@@ -215,6 +215,87 @@ test_extents_cff2_vsindex_named_instance (void)
   hb_font_destroy (font);
 }
 
+static void
+check_extents_cff2_glyph1 (hb_font_t *font, hb_bool_t varied)
+{
+  hb_glyph_extents_t  extents;
+  hb_bool_t result = hb_font_get_glyph_extents (font, 1, &extents);
+  g_assert (result);
+
+  g_assert_cmpint (extents.x_bearing, ==, varied ? 38 : 46);
+  g_assert_cmpint (extents.y_bearing, ==, varied ? 493 : 487);
+  g_assert_cmpint (extents.width, ==, varied ? 480 : 455);
+  g_assert_cmpint (extents.height, ==, varied ? -507 : -500);
+}
+
+static void
+test_extents_cff2_coords_change (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/AdobeVFPrototype.abc.otf");
+  g_assert (face);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+  g_assert (font);
+  hb_ot_font_set_funcs (font);
+
+  /* Outlines are cached per face and per coordinates; check
+   * that going back and forth gives the right extents. */
+  float coords[2] = { 600.0f, 50.0f };
+  float other_coords[2] = { 900.0f, 0.0f };
+  check_extents_cff2_glyph1 (font, FALSE);
+  hb_font_set_var_coords_design (font, coords, 2);
+  check_extents_cff2_glyph1 (font, TRUE);
+  check_extents_cff2_glyph1 (font, TRUE);
+  hb_font_set_var_coords_design (font, NULL, 0);
+  check_extents_cff2_glyph1 (font, FALSE);
+  hb_font_set_var_coords_design (font, other_coords, 2);
+  hb_glyph_extents_t  extents;
+  g_assert (hb_font_get_glyph_extents (font, 1, &extents));
+  g_assert_cmpint (extents.width, !=, 455);
+  g_assert_cmpint (extents.width, !=, 480);
+  hb_font_set_var_coords_design (font, coords, 2);
+  check_extents_cff2_glyph1 (font, TRUE);
+
+  hb_font_destroy (font);
+}
+
+static void
+test_extents_cff1_cache_collisions (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSansPro-Regular.otf");
+  g_assert (face);
+  hb_font_t *font = hb_font_create (face);
+
+  /* 512 apart, so they share a slot of the extents cache; each must
+   * replace the other there, not be served the other's extents. */
+  hb_codepoint_t glyphs[] = { 36, 36 + 512, 36 + 1024 };
+  hb_glyph_extents_t expected[3];
+  unsigned int i, round;
+
+  for (i = 0; i < 3; i++)
+  {
+    hb_font_t *fresh = hb_font_create (face);
+    g_assert (hb_font_get_glyph_extents (fresh, glyphs[i], &expected[i]));
+    hb_font_destroy (fresh);
+  }
+  g_assert_cmpint (expected[0].width, !=, expected[1].width);
+  g_assert_cmpint (expected[1].width, !=, expected[2].width);
+
+  for (round = 0; round < 3; round++)
+    for (i = 0; i < 3; i++)
+    {
+      hb_glyph_extents_t extents;
+      g_assert (hb_font_get_glyph_extents (font, glyphs[i], &extents));
+      g_assert_cmpint (extents.x_bearing, ==, expected[i].x_bearing);
+      g_assert_cmpint (extents.y_bearing, ==, expected[i].y_bearing);
+      g_assert_cmpint (extents.width, ==, expected[i].width);
+      g_assert_cmpint (extents.height, ==, expected[i].height);
+    }
+
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -226,6 +307,8 @@ main (int argc, char **argv)
   hb_test_add (test_extents_cff2);
   hb_test_add (test_extents_cff2_vsindex);
   hb_test_add (test_extents_cff2_vsindex_named_instance);
+  hb_test_add (test_extents_cff2_coords_change);
+  hb_test_add (test_extents_cff1_cache_collisions);
 
   return hb_test_run ();
 }
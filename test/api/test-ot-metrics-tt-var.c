@@ -61,6 +61,46 @@ test_extents_tt_var (void)
   hb_font_destroy (font);
 }
 
+static void
+check_extents_tt_var_glyph2 (hb_font_t *font, int x_bearing, int y_bearing, int width, int height)
+{
+  hb_glyph_extents_t  extents;
+  hb_bool_t result = hb_font_get_glyph_extents (font, 2, &extents);
+  g_assert (result);
+
+  g_assert_cmpint (extents.x_bearing, ==, x_bearing);
+  g_assert_cmpint (extents.y_bearing, ==, y_bearing);
+  g_assert_cmpint (extents.width, ==, width);
+  g_assert_cmpint (extents.height, ==, height);
+}
+
+static void
+test_extents_tt_var_font_changes (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSansVariable-Roman-nohvar-41,C1.ttf");
+  g_assert (face);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+  g_assert (font);
+  hb_ot_font_set_funcs (font);
+
+  /* Extents are cached per font; check that they follow
+   * changes to the variations and scale. */
+  float coords[1] = { 500.0f };
+  check_extents_tt_var_glyph2 (font, 10, 846, 500, -846);
+  check_extents_tt_var_glyph2 (font, 10, 846, 500, -846);
+  hb_font_set_var_coords_design (font, coords, 1);
+  check_extents_tt_var_glyph2 (font, 0, 874, 551, -874);
+  hb_font_set_scale (font, 2000, 2000);
+  check_extents_tt_var_glyph2 (font, 1, 1748, 1100, -1748);
+  hb_font_set_var_coords_design (font, NULL, 0);
+  check_extents_tt_var_glyph2 (font, 20, 1692, 1000, -1692);
+  hb_font_set_scale (font, 1000, 1000);
+  check_extents_tt_var_glyph2 (font, 10, 846, 500, -846);
+
+  hb_font_destroy (font);
+}
+
 static void
 test_advance_tt_var_nohvar (void)
 {
@@ -251,18 +291,138 @@ test_advance_tt_var_gvar_infer (void)
   hb_font_destroy (font);
 }
 
+static void
+check_same_metrics (hb_font_t *font, hb_font_t *expected)
+{
+  unsigned int num_glyphs = hb_face_get_glyph_count (hb_font_get_face (expected));
+  g_assert_cmpuint (num_glyphs, >, 1);
+  for (hb_codepoint_t gid = 0; gid < num_glyphs; gid++)
+  {
+    hb_glyph_extents_t extents = {0}, expected_extents = {0};
+    g_assert_cmpint (hb_font_get_glyph_h_advance (font, gid), ==,
+		     hb_font_get_glyph_h_advance (expected, gid));
+    g_assert_cmpint (hb_font_get_glyph_extents (font, gid, &extents), ==,
+		     hb_font_get_glyph_extents (expected, gid, &expected_extents));
+    g_assert_cmpint (extents.x_bearing, ==, expected_extents.x_bearing);
+    g_assert_cmpint (extents.y_bearing, ==, expected_extents.y_bearing);
+    g_assert_cmpint (extents.width, ==, expected_extents.width);
+    g_assert_cmpint (extents.height, ==, expected_extents.height);
+  }
+}
+
+static unsigned int
+_be16 (const char *p)
+{
+  const unsigned char *u = (const unsigned char *) p;
+  return (u[0] << 8) | u[1];
+}
+
+static unsigned int
+_be32 (const char *p)
+{
+  return (_be16 (p) << 16) | _be16 (p + 2);
+}
+
+static void
+_halve_f2dot14 (char *p, unsigned int count)
+{
+  unsigned char *u = (unsigned char *) p;
+  for (unsigned int i = 0; i < count; i++, u += 2)
+  {
+    int v = (int16_t) ((u[0] << 8) | u[1]) / 2;
+    u[0] = (unsigned) v >> 8;
+    u[1] = v;
+  }
+}
+
+static char *
+_table_in (hb_face_t *face, hb_tag_t tag, char *data)
+{
+  hb_blob_t *blob = hb_face_reference_table (face, tag);
+  const char *table = hb_blob_get_data (blob, NULL);
+  hb_blob_destroy (blob);
+  g_assert (table);
+  return data + (table - data);
+}
+
+static void
+test_advance_tt_var_face_changes (void)
+{
+  int coords[1] = { 8000 };
+  int coords2[1] = { -5000 };
+
+  /* Variation data cached on the font must not outlive its face, even
+   * if the next face is loaded where the old one was.  Load both from
+   * the same memory, changing the gvar shared tuples and the HVAR
+   * regions in between. */
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSerifVariable-Roman-VVAR.abc.ttf");
+  hb_blob_t *blob = hb_face_reference_blob (face);
+  hb_face_destroy (face);
+  unsigned int length;
+  const char *file_data = hb_blob_get_data (blob, &length);
+  char *data = (char *) malloc (length);
+  memcpy (data, file_data, length);
+  hb_blob_destroy (blob);
+  blob = hb_blob_create (data, length, HB_MEMORY_MODE_READONLY, NULL, NULL);
+
+  face = hb_face_create (blob, 0);
+  hb_font_t *font = hb_font_create (face);
+  hb_ot_font_set_funcs (font);
+  hb_font_set_var_coords_normalized (font, coords, 1);
+  hb_font_t *expected = hb_font_create (face);
+  hb_ot_font_set_funcs (expected);
+  hb_font_set_var_coords_normalized (expected, coords, 1);
+  check_same_metrics (font, expected);
+  hb_font_destroy (expected);
+
+  hb_font_set_var_coords_normalized (font, coords2, 1);
+  expected = hb_font_create (face);
+  hb_ot_font_set_funcs (expected);
+  hb_font_set_var_coords_normalized (expected, coords2, 1);
+  check_same_metrics (font, expected);
+  hb_font_destroy (expected);
+
+  char *gvar = _table_in (face, HB_TAG ('g','v','a','r'), data);
+  char *hvar = _table_in (face, HB_TAG ('H','V','A','R'), data);
+  hb_font_set_face (font, NULL);
+  hb_face_destroy (face);
+
+  /* gvar: axisCount, sharedTupleCount, sharedTuplesOffset. */
+  _halve_f2dot14 (gvar + _be32 (gvar + 8), _be16 (gvar + 4) * _be16 (gvar + 6));
+  /* HVAR: itemVariationStore -> variationRegionList -> regions. */
+  char *varstore = hvar + _be32 (hvar + 4);
+  char *regions = varstore + _be32 (varstore + 2);
+  _halve_f2dot14 (regions + 4, _be16 (regions) * _be16 (regions + 2) * 3);
+
+  face = hb_face_create (blob, 0);
+  hb_font_set_face (font, face);
+  hb_ot_font_set_funcs (font);
+  expected = hb_font_create (face);
+  hb_ot_font_set_funcs (expected);
+  hb_font_set_var_coords_normalized (expected, coords2, 1);
+  check_same_metrics (font, expected);
+  hb_font_destroy (expected);
+
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+  hb_blob_destroy (blob);
+  free (data);
+}
+
 int
 main (int argc, char **argv)
 {
   hb_test_init (&argc, &argv);
 
   hb_test_add (test_extents_tt_var);
+  hb_test_add (test_extents_tt_var_font_changes);
   hb_test_add (test_advance_tt_var_nohvar);
   hb_test_add (test_advance_tt_var_hvarvvar);
   hb_test_add (test_advance_tt_var_anchor);
   hb_test_add (test_extents_tt_var_comp);
   hb_test_add (test_advance_tt_var_comp_v);
   hb_test_add (test_advance_tt_var_gvar_infer);
+  hb_test_add (test_advance_tt_var_face_changes);
 
   return hb_test_run ();
 }
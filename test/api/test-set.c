@@ -574,6 +574,109 @@ test_set_delrange (void)
   hb_set_destroy (s);
 }
 
+static void
+test_set_invert (void)
+{
+  hb_codepoint_t first, last;
+  hb_set_t *s = hb_set_create ();
+  hb_set_t *o = hb_set_create ();
+
+  hb_set_add (s, 10);
+  hb_set_add_range (s, 20, 29);
+  hb_set_invert (s);
+  g_assert (!hb_set_is_empty (s));
+  g_assert (!hb_set_has (s, 10));
+  g_assert (hb_set_has (s, 11));
+  g_assert (!hb_set_has (s, 25));
+  g_assert (hb_set_has (s, 1000000));
+  g_assert_cmpint (hb_set_get_population (s), ==, HB_SET_VALUE_INVALID - 11);
+  g_assert_cmpint (hb_set_get_min (s), ==, 0);
+  g_assert_cmpint (hb_set_get_max (s), ==, HB_SET_VALUE_INVALID - 1);
+
+  first = 9;
+  g_assert (hb_set_next (s, &first));
+  g_assert_cmpint (first, ==, 11);
+  first = 25;
+  g_assert (hb_set_previous (s, &first));
+  g_assert_cmpint (first, ==, 19);
+
+  first = last = 10;
+  g_assert (hb_set_next_range (s, &first, &last));
+  g_assert_cmpint (first, ==, 11);
+  g_assert_cmpint (last, ==, 19);
+  g_assert (hb_set_next_range (s, &first, &last));
+  g_assert_cmpint (first, ==, 30);
+  g_assert_cmpint (last, ==, HB_SET_VALUE_INVALID - 1);
+  g_assert (!hb_set_next_range (s, &first, &last));
+
+  first = last = HB_SET_VALUE_INVALID;
+  g_assert (hb_set_previous_range (s, &first, &last));
+  g_assert_cmpint (first, ==, 30);
+  g_assert_cmpint (last, ==, HB_SET_VALUE_INVALID - 1);
+
+  /* Adding to an inverted set removes from what it excludes. */
+  hb_set_add (s, 10);
+  hb_set_del (s, 1000);
+  g_assert (hb_set_has (s, 10));
+  g_assert (!hb_set_has (s, 1000));
+
+  hb_set_add_range (o, 20, 24);
+  g_assert (!hb_set_is_subset (o, s));
+  hb_set_clear (o);
+  hb_set_add_range (o, 100, 200);
+  g_assert (hb_set_is_subset (o, s));
+  g_assert (!hb_set_is_subset (s, o));
+
+  /* Inverted ∩ plain is plain again. */
+  hb_set_intersect (o, s);
+  g_assert_cmpint (hb_set_get_population (o), ==, 101);
+  hb_set_intersect (s, o);
+  g_assert (hb_set_is_equal (s, o));
+  g_assert_cmpint (hb_set_get_population (s), ==, 101);
+
+  hb_set_invert (s);
+  hb_set_invert (s);
+  g_assert (hb_set_is_equal (s, o));
+
+  hb_set_clear (s);
+  hb_set_invert (s);
+  g_assert_cmpint (hb_set_get_population (s), ==, HB_SET_VALUE_INVALID);
+  first = HB_SET_VALUE_INVALID;
+  g_assert (hb_set_next (s, &first));
+  g_assert_cmpint (first, ==, 0);
+  first = HB_SET_VALUE_INVALID;
+  g_assert (hb_set_previous (s, &first));
+  g_assert_cmpint (first, ==, HB_SET_VALUE_INVALID - 1);
+  hb_set_clear (s);
+  test_empty (s);
+
+  hb_set_destroy (o);
+  hb_set_destroy (s);
+}
+
+static void
+test_set_previous_empty_page (void)
+{
+  hb_codepoint_t g;
+  hb_set_t *s = hb_set_create ();
+  hb_set_t *o = hb_set_create ();
+
+  /* The intersection keeps both pages around, empty. */
+  hb_set_add_range (s, 0, 600);
+  hb_set_add (s, 1100);
+  hb_set_add (o, 700);
+  hb_set_add (o, 1101);
+  hb_set_intersect (s, o);
+
+  g = 1030;
+  g_assert (!hb_set_previous (s, &g));
+  g_assert_cmpint (g, ==, HB_SET_VALUE_INVALID);
+  test_empty (s);
+
+  hb_set_destroy (o);
+  hb_set_destroy (s);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -585,6 +688,8 @@ main (int argc, char **argv)
   hb_test_add (test_set_iter);
   hb_test_add (test_set_empty);
   hb_test_add (test_set_delrange);
+  hb_test_add (test_set_invert);
+  hb_test_add (test_set_previous_empty_page);
 
   hb_test_add (test_set_intersect_empty);
   hb_test_add (test_set_intersect_page_reduction);
@@ -179,6 +179,187 @@ test_shape_clusters (void)
   hb_font_destroy (font);
 }
 
+static void
+test_shape_skip_cluster_tracking (void)
+{
+  hb_face_t *face;
+  hb_font_t *font;
+  hb_buffer_t *buffer;
+  unsigned int len;
+  hb_glyph_info_t *glyphs;
+  hb_codepoint_t test[] = {'a', 0x0301, 'b'};
+
+  face = hb_face_create (NULL, 0);
+  font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  buffer =  hb_buffer_create ();
+  hb_buffer_set_direction (buffer, HB_DIRECTION_LTR);
+  hb_buffer_set_cluster_level (buffer, HB_BUFFER_CLUSTER_LEVEL_CHARACTERS);
+  hb_buffer_add_utf32 (buffer, test, 3, 0, 3);
+  hb_shape (font, buffer, NULL, 0);
+
+  /* The mark is unsafe to break from its base. */
+  len = hb_buffer_get_length (buffer);
+  glyphs = hb_buffer_get_glyph_infos (buffer, NULL);
+  g_assert_cmpint (len, ==, 3);
+  g_assert_cmphex (hb_glyph_info_get_glyph_flags (&glyphs[1]), ==, HB_GLYPH_FLAG_UNSAFE_TO_BREAK);
+
+  hb_buffer_clear_contents (buffer);
+  hb_buffer_set_direction (buffer, HB_DIRECTION_LTR);
+  hb_buffer_set_flags (buffer, HB_BUFFER_FLAG_SKIP_CLUSTER_TRACKING);
+  hb_buffer_add_utf32 (buffer, test, 3, 0, 3);
+  hb_shape (font, buffer, NULL, 0);
+
+  /* Not even in the default cluster level, and clusters stay unmerged. */
+  len = hb_buffer_get_length (buffer);
+  glyphs = hb_buffer_get_glyph_infos (buffer, NULL);
+  {
+    unsigned int i;
+    g_assert_cmpint (len, ==, 3);
+    for (i = 0; i < len; i++) {
+      g_assert_cmphex (glyphs[i].cluster, ==, i);
+      g_assert_cmphex (hb_glyph_info_get_glyph_flags (&glyphs[i]), ==, 0);
+    }
+  }
+
+  hb_buffer_destroy (buffer);
+  hb_font_destroy (font);
+}
+#ifdef HB_EXPERIMENTAL_API
+static void
+test_shape_batch (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_buffer_t *batch = hb_buffer_create ();
+  hb_buffer_t *buffer = hb_buffer_create ();
+  /* Mixed scripts, so runs have different guessed properties. */
+  const char text[] = "\331\204\330\250\330\263 abc \330\250\330\250 x";
+  hb_shape_batch_run_t runs[4];
+  unsigned int offsets[] = {0, 7, 11, 16};
+  unsigned int lengths[] = {6, 3, 4, 1};
+  unsigned int i, j, len;
+
+  memset (runs, 0, sizeof (runs));
+  for (i = 0; i < 4; i++)
+  {
+    runs[i].offset = offsets[i];
+    runs[i].length = lengths[i];
+  }
+
+  hb_buffer_set_flags (batch, HB_BUFFER_FLAG_BOT | HB_BUFFER_FLAG_EOT);
+  g_assert (hb_shape_batch_utf8 (font, batch, text, -1, runs, 4, NULL, 0));
+
+  for (i = 0; i < 4; i++)
+  {
+    hb_glyph_info_t *batch_infos = hb_buffer_get_glyph_infos (batch, NULL) + runs[i].glyph_start;
+    hb_glyph_position_t *batch_positions = hb_buffer_get_glyph_positions (batch, NULL) + runs[i].glyph_start;
+    hb_glyph_info_t *infos;
+    hb_glyph_position_t *positions;
+
+    hb_buffer_clear_contents (buffer);
+    hb_buffer_set_flags (buffer, (i == 0 ? HB_BUFFER_FLAG_BOT : 0) |
+				 (i == 3 ? HB_BUFFER_FLAG_EOT : 0));
+    hb_buffer_add_utf8 (buffer, text, -1, offsets[i], lengths[i]);
+    hb_buffer_guess_segment_properties (buffer);
+    hb_shape (font, buffer, NULL, 0);
+
+    infos = hb_buffer_get_glyph_infos (buffer, &len);
+    positions = hb_buffer_get_glyph_positions (buffer, NULL);
+    g_assert_cmpuint (runs[i].glyph_length, ==, len);
+    for (j = 0; j < len; j++)
+    {
+      g_assert_cmpuint (batch_infos[j].codepoint, ==, infos[j].codepoint);
+      g_assert_cmpuint (batch_infos[j].cluster, ==, infos[j].cluster);
+      g_assert_cmpint (batch_positions[j].x_advance, ==, positions[j].x_advance);
+      g_assert_cmpint (batch_positions[j].x_offset, ==, positions[j].x_offset);
+      g_assert_cmpint (batch_positions[j].y_offset, ==, positions[j].y_offset);
+    }
+  }
+  g_assert_cmpuint (runs[3].glyph_start + runs[3].glyph_length, ==, hb_buffer_get_length (batch));
+
+  /* A run out of the text fails, keeping the runs before it. */
+  runs[2].length = 100;
+  g_assert (!hb_shape_batch_utf8 (font, batch, text, -1, runs, 4, NULL, 0));
+  g_assert_cmpuint (hb_buffer_get_length (batch), ==, runs[2].glyph_start);
+  g_assert_cmpuint (runs[2].glyph_length, ==, 0);
+
+  hb_buffer_destroy (buffer);
+  hb_buffer_destroy (batch);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
+static void
+shape_cached_and_compare (hb_shape_cache_t *cache, hb_font_t *font,
+			  const char *text, unsigned int offset, unsigned int length)
+{
+  hb_buffer_t *cached = hb_buffer_create ();
+  hb_buffer_t *buffer = hb_buffer_create ();
+  hb_glyph_info_t *cached_infos, *infos;
+  hb_glyph_position_t *cached_positions, *positions;
+  unsigned int i, len;
+
+  hb_buffer_add_utf8 (cached, text, -1, offset, length);
+  hb_buffer_guess_segment_properties (cached);
+  g_assert (hb_shape_cached (cache, font, cached, NULL, 0));
+
+  hb_buffer_add_utf8 (buffer, text, -1, offset, length);
+  hb_buffer_guess_segment_properties (buffer);
+  hb_shape (font, buffer, NULL, 0);
+
+  g_assert_cmpint (hb_buffer_get_content_type (cached), ==, HB_BUFFER_CONTENT_TYPE_GLYPHS);
+  g_assert_cmpuint (hb_buffer_get_length (cached), ==, hb_buffer_get_length (buffer));
+  cached_infos = hb_buffer_get_glyph_infos (cached, NULL);
+  cached_positions = hb_buffer_get_glyph_positions (cached, NULL);
+  infos = hb_buffer_get_glyph_infos (buffer, &len);
+  positions = hb_buffer_get_glyph_positions (buffer, NULL);
+  for (i = 0; i < len; i++)
+  {
+    g_assert_cmpuint (cached_infos[i].codepoint, ==, infos[i].codepoint);
+    g_assert_cmpuint (cached_infos[i].cluster, ==, infos[i].cluster);
+    g_assert_cmpuint (hb_glyph_info_get_glyph_flags (&cached_infos[i]), ==,
+		      hb_glyph_info_get_glyph_flags (&infos[i]));
+    g_assert_cmpint (cached_positions[i].x_advance, ==, positions[i].x_advance);
+    g_assert_cmpint (cached_positions[i].x_offset, ==, positions[i].x_offset);
+    g_assert_cmpint (cached_positions[i].y_offset, ==, positions[i].y_offset);
+  }
+
+  hb_buffer_destroy (buffer);
+  hb_buffer_destroy (cached);
+}
+
+static void
+test_shape_cached (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_shape_cache_t *cache = hb_shape_cache_create ();
+  /* The same word at different offsets, once joining to its context. */
+  const char text[] = "\330\250\330\250 \330\250\330\250 \330\250\330\250\330\250\330\250";
+  unsigned int offsets[] = {0, 5, 5, 10, 0};
+  unsigned int i;
+
+  for (i = 0; i < 5; i++)
+    shape_cached_and_compare (cache, font, text, offsets[i], 4);
+
+  /* Changing the font drops what was shaped with it. */
+  hb_font_set_scale (font, 2000, 2000);
+  for (i = 0; i < 5; i++)
+    shape_cached_and_compare (cache, font, text, offsets[i], 4);
+
+  hb_shape_cache_clear (cache);
+  shape_cached_and_compare (cache, font, text, 0, 4);
+
+  /* The empty cache shapes without caching. */
+  shape_cached_and_compare (hb_shape_cache_get_empty (), font, text, 0, 4);
+
+  hb_shape_cache_destroy (cache);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+#endif
 
 static void
 test_shape_list (void)
@@ -200,6 +381,11 @@ main (int argc, char **argv)
 
   hb_test_add (test_shape);
   hb_test_add (test_shape_clusters);
+  hb_test_add (test_shape_skip_cluster_tracking);
+#ifdef HB_EXPERIMENTAL_API
+  hb_test_add (test_shape_batch);
+  hb_test_add (test_shape_cached);
+#endif
   /* TODO test fallback shaper */
   /* TODO test shaper_full */
   hb_test_add (test_shape_list);
@@ -95,6 +95,73 @@ test_subset_crash (void)
   hb_face_destroy (face);
 }
 
+#ifdef HB_EXPERIMENTAL_API
+typedef struct parallel_for_data_t
+{
+  unsigned int tasks;
+  hb_bool_t destroyed;
+} parallel_for_data_t;
+
+static void
+_serial_for (unsigned int           count,
+	     hb_subset_task_func_t  task,
+	     void                  *task_data,
+	     void                  *user_data)
+{
+  parallel_for_data_t *data = (parallel_for_data_t *) user_data;
+  /* Run them backwards; the order must not matter. */
+  for (unsigned int i = count; i; i--)
+  {
+    task (i - 1, task_data);
+    data->tasks++;
+  }
+}
+
+static void
+_serial_for_destroy (void *user_data)
+{
+  ((parallel_for_data_t *) user_data)->destroyed = TRUE;
+}
+
+static void
+test_subset_parallel_for (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Regular.abc.ttf");
+  parallel_for_data_t data = {0, FALSE};
+
+  hb_set_t *codepoints = hb_set_create ();
+  hb_set_add (codepoints, 'a');
+  hb_set_add (codepoints, 'c');
+
+  hb_subset_input_t *input = hb_subset_test_create_input (codepoints);
+  hb_face_t *expected = hb_subset (face, input);
+  hb_subset_input_destroy (input);
+
+  input = hb_subset_test_create_input (codepoints);
+  hb_subset_input_set_parallel_for_func (input, _serial_for, &data, _serial_for_destroy);
+  hb_face_t *subset = hb_subset (face, input);
+  g_assert (!data.destroyed);
+  hb_subset_input_destroy (input);
+  g_assert (data.destroyed);
+  g_assert_cmpuint (data.tasks, >, 1);
+
+  hb_blob_t *expected_blob = hb_face_reference_blob (expected);
+  hb_blob_t *subset_blob = hb_face_reference_blob (subset);
+  unsigned int expected_length, subset_length;
+  const char *expected_data = hb_blob_get_data (expected_blob, &expected_length);
+  const char *subset_data = hb_blob_get_data (subset_blob, &subset_length);
+  g_assert_cmpuint (expected_length, >, 0);
+  g_assert_cmpmem (subset_data, subset_length, expected_data, expected_length);
+
+  hb_blob_destroy (expected_blob);
+  hb_blob_destroy (subset_blob);
+  hb_face_destroy (subset);
+  hb_face_destroy (expected);
+  hb_set_destroy (codepoints);
+  hb_face_destroy (face);
+}
+#endif
+
 int
 main (int argc, char **argv)
 {
@@ -103,6 +170,9 @@ main (int argc, char **argv)
   hb_test_add (test_subset_32_tables);
   hb_test_add (test_subset_no_inf_loop);
   hb_test_add (test_subset_crash);
+#ifdef HB_EXPERIMENTAL_API
+  hb_test_add (test_subset_parallel_for);
+#endif
 
   return hb_test_run();
 }